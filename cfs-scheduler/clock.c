@@ -0,0 +1,355 @@
+// Nanosecond clock and high-resolution timers.
+// At boot, clockinit() times a 10ms window of PIT channel 2 with both
+// the TSC and the LAPIC timer, which gives their rates.  nsecs() then
+// reads time since boot off the TSC, and each CPU runs its LAPIC timer
+// in one-shot mode, programmed for whichever comes first: the next
+// scheduler tick or the earliest high-resolution timer.  So a timer
+// fires when it is due instead of at the next 10ms tick.
+//
+// The tick is dynamic (NOHZ): a CPU that is idle or running its only
+// runnable process stops it and programs the timer for its next
+// hrtimer or timer-wheel expiry instead.  Global ticks is derived from
+// the TSC rather than counted by CPU 0, so it stays right while every
+// CPU's tick is stopped, and a CPU catches up on the ticks it skipped
+// when it next takes one.
+//
+// If calibration fails, the LAPIC timer stays periodic, nsecs() counts
+// in ticks, and hrtimers run at tick granularity.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "timer.h"
+#include "x86.h"
+
+#define NSEC_PER_MSEC 1000000
+#define NSEC_PER_TICK (10 * NSEC_PER_MSEC) // Nominal, if uncalibrated
+
+#define PIT_HZ 1193182
+#define CAL_MS 10       // Length of the calibration window
+#define CAL_SPINS 100000000
+
+#define NOHZ_MAX_NS (1000ull * NSEC_PER_MSEC) // Longest a stopped tick sleeps
+
+struct clock_base
+{
+    struct spinlock lock;
+    uint tick;                 // Last tick this CPU processed
+    struct hrtimer *head;      // Pending timers, earliest first
+};
+
+static struct clock_base hrbases[NCPU];
+
+static uint tsc_khz;           // TSC cycles per millisecond
+static uint lapic_khz;         // LAPIC timer counts per millisecond
+static uint64 tsc_boot;        // TSC at calibration
+static uint64 tick_ns;         // Length of a tick
+static int oneshot;            // Calibrated; LAPIC timers are one-shot
+
+// 64-by-32-bit division: no libgcc for __udivdi3.
+uint64 div64_32(uint64 n, uint d, uint *rem)
+{
+    uint hi = n >> 32, lo = n, qhi, qlo, r;
+
+    qhi = hi / d;
+    hi %= d;
+    asm("divl %4" : "=a"(qlo), "=d"(r) : "a"(lo), "d"(hi), "rm"(d));
+    if (rem)
+        *rem = r;
+    return ((uint64)qhi << 32) | qlo;
+}
+
+// Time PIT channel 2 counting down CAL_MS with the TSC and the
+// LAPIC timer.  Returns 0 if the PIT never finished.
+static int
+calibrate(void)
+{
+    uint latch = PIT_HZ / (1000 / CAL_MS);
+    uint c0, c1, spins = 0;
+    uint64 t0, t1;
+
+    // Gate channel 2 on with the speaker off, and load it in mode 0:
+    // its output, bit 5 of port 0x61, rises at terminal count.
+    outb(0x61, (inb(0x61) & ~0x02) | 0x01);
+    outb(0x43, 0xB0);
+    outb(0x42, latch & 0xFF);
+    outb(0x42, latch >> 8);
+
+    lapiconeshot(0xFFFFFFFF);
+    c0 = lapiccount();
+    t0 = rdtsc64();
+    while ((inb(0x61) & 0x20) == 0)
+        if (++spins > CAL_SPINS)
+            return 0;
+    t1 = rdtsc64();
+    c1 = lapiccount();
+
+    tsc_khz = div64_32(t1 - t0, CAL_MS, 0);
+    lapic_khz = (c0 - c1) / CAL_MS;
+    tsc_boot = t1;
+    return tsc_khz != 0 && lapic_khz != 0;
+}
+
+void clockinit(void)
+{
+    int i;
+
+    for (i = 0; i < NCPU; i++)
+        initlock(&hrbases[i].lock, "clock");
+    if (!calibrate())
+    {
+        cprintf("clock: PIT calibration failed, using ticks\n");
+        lapicperiodic();
+        return;
+    }
+    tick_ns = div64_32((uint64)TIMER_TICR * NSEC_PER_MSEC, lapic_khz, 0);
+    oneshot = 1;
+    cprintf("clock: tsc %d kHz, lapic %d kHz, tick %d us\n",
+            tsc_khz, lapic_khz, (uint)div64_32(tick_ns, 1000, 0));
+}
+
+// Nanoseconds since boot.
+uint64 nsecs(void)
+{
+    uint64 ms;
+    uint rem;
+
+    if (!oneshot)
+        return (uint64)ticks * NSEC_PER_TICK;
+    ms = div64_32(rdtsc64() - tsc_boot, tsc_khz, &rem);
+    return ms * NSEC_PER_MSEC +
+           div64_32((uint64)rem * NSEC_PER_MSEC, tsc_khz, 0);
+}
+
+// Bring the global ticks up to date with the TSC.  Uncalibrated,
+// CPU 0's periodic interrupt counts ticks instead.
+void ticks_update(void)
+{
+    uint t;
+
+    if (!oneshot)
+        return;
+    t = div64_32(nsecs(), tick_ns, 0);
+    if ((int)(t - ticks) <= 0)
+        return;
+    acquire(&tickslock);
+    if ((int)(t - ticks) > 0)
+        ticks = t;
+    release(&tickslock);
+}
+
+// Program this CPU's LAPIC timer for the earlier of its next event:
+// the next tick or, with the tick stopped, the next timer-wheel
+// expiry; and its first hrtimer.  Caller holds b->lock.
+static void
+program(struct clock_base *b, uint64 now)
+{
+    uint64 next, counts;
+    uint when;
+
+    if (!mycpu()->tick_stopped)
+        next = (uint64)(b->tick + 1) * tick_ns;
+    else
+    {
+        next = now + NOHZ_MAX_NS;
+        if (timer_next(&when) && (uint64)when * tick_ns < next)
+            next = (uint64)when * tick_ns;
+    }
+    if (b->head && b->head->expires < next)
+        next = b->head->expires;
+    if (next <= now)
+        counts = 1;
+    else
+        counts = div64_32((next - now) * lapic_khz + NSEC_PER_MSEC - 1,
+                          NSEC_PER_MSEC, 0);
+    if (counts == 0)
+        counts = 1;
+    if (counts > 0xFFFFFFFF)
+        counts = 0xFFFFFFFF;
+    lapiconeshot(counts);
+}
+
+// Switch this CPU's LAPIC timer to one-shot mode.  Called by each
+// CPU before it enters the scheduler.
+void clock_start(void)
+{
+    struct clock_base *b = &hrbases[cpuid()];
+
+    if (!oneshot)
+        return;
+    acquire(&b->lock);
+    b->tick = div64_32(nsecs(), tick_ns, 0);
+    program(b, nsecs());
+    release(&b->lock);
+}
+
+// Timer interrupt: run this CPU's expired hrtimers, decide whether
+// it still needs its tick, and rearm the LAPIC timer.  Returns the
+// number of ticks since the last one this CPU processed: normally
+// 0 or 1, more when its tick was stopped.
+int clock_intr(void)
+{
+    struct clock_base *b = &hrbases[cpuid()];
+    struct hrtimer *t;
+    uint64 now;
+    uint cur;
+    int n;
+
+    acquire(&b->lock);
+    now = nsecs();
+    while ((t = b->head) != 0 && t->expires <= now)
+    {
+        b->head = t->next;
+        t->next = 0;
+        t->pending = 0;
+        t->fn(t->arg);
+    }
+    if (!oneshot)
+    {
+        release(&b->lock);
+        if (cpuid() == 0)
+        {
+            acquire(&tickslock);
+            ticks++;
+            release(&tickslock);
+        }
+        return 1;
+    }
+    cur = div64_32(now, tick_ns, 0);
+    n = cur - b->tick;
+    b->tick = cur;
+    // Stop the tick before looking at the runqueue: kick_idle() queues
+    // before looking at tick_stopped, so one of us sees the other.
+    mycpu()->tick_stopped = 1;
+    __sync_synchronize();
+    if (sched_tick_needed())
+        mycpu()->tick_stopped = 0;
+    program(b, now);
+    release(&b->lock);
+    if (n)
+        ticks_update();
+    return n;
+}
+
+// Restart this CPU's stopped tick, because it has a process to
+// share the CPU with or is leaving idle.  Returns the ticks that
+// passed while it was stopped.  Interrupts must be off.
+int clock_restart(void)
+{
+    struct clock_base *b = &hrbases[cpuid()];
+    uint cur;
+    int n;
+
+    if (!mycpu()->tick_stopped)
+        return 0;
+    acquire(&b->lock);
+    cur = div64_32(nsecs(), tick_ns, 0);
+    n = cur - b->tick;
+    b->tick = cur;
+    mycpu()->tick_stopped = 0;
+    program(b, nsecs());
+    release(&b->lock);
+    if (n)
+        ticks_update();
+    return n;
+}
+
+// Reprogram this CPU's timer after a timer-wheel timer was added
+// while its tick is stopped.
+void clock_reprogram(void)
+{
+    struct clock_base *b = &hrbases[cpuid()];
+
+    acquire(&b->lock);
+    program(b, nsecs());
+    release(&b->lock);
+}
+
+// Arrange for t's function to run once nsecs() reaches expires.
+// t must not be pending.  The timer goes on this CPU's queue and,
+// like a timer-wheel callback, runs with the queue's lock held.
+void hrtimer_add(struct hrtimer *t, uint64 expires)
+{
+    struct clock_base *b;
+    struct hrtimer **pp;
+
+    pushcli();
+    b = &hrbases[cpuid()];
+    acquire(&b->lock);
+    if (t->pending)
+        panic("hrtimer_add: pending");
+    t->expires = expires;
+    for (pp = &b->head; *pp && (*pp)->expires <= expires; pp = &(*pp)->next)
+        ;
+    t->next = *pp;
+    *pp = t;
+    t->pending = 1;
+    t->base = b;
+    if (oneshot && b->head == t)
+        program(b, nsecs());
+    release(&b->lock);
+    popcli();
+}
+
+// Stop t if it is pending.  Returns 1 if it was, 0 if it had
+// already run.  Once this returns, t's function is not running.
+int hrtimer_cancel(struct hrtimer *t)
+{
+    struct clock_base *b = t->base;
+    struct hrtimer **pp;
+
+    if (b == 0)
+        return 0;
+    acquire(&b->lock);
+    if (!t->pending)
+    {
+        release(&b->lock);
+        return 0;
+    }
+    for (pp = &b->head; *pp != t; pp = &(*pp)->next)
+        ;
+    *pp = t->next;
+    t->next = 0;
+    t->pending = 0;
+    release(&b->lock);
+    return 1;
+}
+
+// hrtimer callback: wake the process in nsleep().
+static void
+nsleep_timeout(void *chan)
+{
+    wakeup(chan);
+}
+
+// Sleep for ns nanoseconds.  Returns -1 if killed.
+int nsleep(uint64 ns)
+{
+    struct hrtimer t;
+    struct clock_base *b;
+    int r = 0;
+
+    t.fn = nsleep_timeout;
+    t.arg = &t;
+    t.pending = 0;
+    t.next = 0;
+    t.base = 0;
+    hrtimer_add(&t, nsecs() + ns);
+    b = t.base;
+    acquire(&b->lock);
+    while (t.pending)
+    {
+        if (myproc()->killed)
+        {
+            r = -1;
+            break;
+        }
+        sleep(&t, &b->lock);
+    }
+    release(&b->lock);
+    hrtimer_cancel(&t);
+    return r;
+}
@@ -0,0 +1,17 @@
+// clock_gettime() clocks
+#define CLOCK_MONOTONIC 1 // time since boot
+
+// Time since boot, as returned by clock_gettime()
+struct timespec {
+  uint tv_sec;
+  uint tv_nsec;
+};
+
+struct rtcdate {
+  uint second;
+  uint minute;
+  uint hour;
+  uint day;
+  uint month;
+  uint year;
+};
@@ -0,0 +1,303 @@
+// Inter-processor interrupts.
+//
+// Three fixed vectors, handled from trap():
+//   IRQ_RESCHED  the target re-runs its scheduler on the way out of
+//                trap() (need_resched); also wakes a halted idle CPU.
+//   IRQ_CALL     the target runs the functions queued on its call
+//                queue and marks each one done.
+//   IRQ_TLB      the target flushes its TLB and acknowledges.
+//
+// A CPU waiting for another to finish a call or a flush keeps
+// serving its own call queue and flush requests, so two CPUs that
+// wait on each other with interrupts off cannot deadlock.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "x86.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "traps.h"
+
+void ipiinit(void)
+{
+    int i;
+
+    for (i = 0; i < ncpu; i++)
+    {
+        initlock(&cpus[i].call_lock, "ipicall");
+        cpus[i].calls = 0;
+        cpus[i].tlb_req = cpus[i].tlb_done = 0;
+    }
+}
+
+// Send vector to CPU c.  Interrupts stay off across the ICR
+// writes: an interrupt handler sending its own IPI between them
+// would overwrite the destination.
+void ipi_send(struct cpu *c, int vector)
+{
+    pushcli();
+    lapicipi(c->apicid, T_IRQ0 + vector);
+    popcli();
+}
+
+// Send vector to every CPU except this one.
+void ipi_broadcast(int vector)
+{
+    pushcli();
+    lapicipi_others(T_IRQ0 + vector);
+    popcli();
+}
+
+// Make CPU c reschedule at its next trap, interrupting it now
+// if it is another CPU.
+void resched_cpu(struct cpu *c)
+{
+    c->need_resched = 1;
+    pushcli();
+    if (c != mycpu())
+    {
+        __sync_synchronize(); // Publish need_resched before the interrupt
+        ipi_send(c, IRQ_RESCHED);
+    }
+    popcli();
+}
+
+// Run the calls queued for this CPU.  Interrupts must be off.
+static void
+run_calls(struct cpu *c)
+{
+    struct ipi_call *call, *next;
+
+    acquire(&c->call_lock);
+    call = c->calls;
+    c->calls = 0;
+    release(&c->call_lock);
+
+    for (; call; call = next)
+    {
+        next = call->next; // call may be reused once done is set
+        call->fn(call->arg);
+        __sync_synchronize();
+        call->done = 1;
+    }
+}
+
+// Flush this CPU's TLB if a flush was requested.  Interrupts must
+// be off.  Recording the request count before flushing means a
+// request made during the flush gets a flush of its own.
+static void
+run_tlb(struct cpu *c)
+{
+    uint req = c->tlb_req;
+
+    if (req == c->tlb_done)
+        return;
+    lcr3(rcr3());
+    __sync_synchronize();
+    c->tlb_done = req;
+}
+
+// IRQ_CALL handler.
+void ipi_call_intr(void)
+{
+    run_calls(mycpu());
+}
+
+// IRQ_TLB handler.
+void ipi_tlb_intr(void)
+{
+    run_tlb(mycpu());
+}
+
+// Spin until *done is set, serving this CPU's own requests.
+static void
+wait_done(volatile int *done)
+{
+    struct cpu *self;
+
+    pushcli();
+    self = mycpu();
+    while (!*done)
+    {
+        run_calls(self);
+        run_tlb(self);
+    }
+    popcli();
+}
+
+// Queue call on CPU c and interrupt it.
+static void
+queue_call(struct cpu *c, struct ipi_call *call)
+{
+    call->done = 0;
+    acquire(&c->call_lock);
+    call->next = c->calls;
+    c->calls = call;
+    release(&c->call_lock);
+    ipi_send(c, IRQ_CALL);
+}
+
+// Run fn(arg) on CPU c and wait for it to finish.  On this CPU the
+// call is made directly, with interrupts off as on any other CPU.
+// fn runs in interrupt context: it must not sleep or take locks the
+// caller might hold.
+void smp_call(struct cpu *c, void (*fn)(void *), void *arg)
+{
+    struct ipi_call call;
+
+    pushcli();
+    if (c == mycpu())
+    {
+        fn(arg);
+        popcli();
+        return;
+    }
+    popcli();
+
+    call.fn = fn;
+    call.arg = arg;
+    queue_call(c, &call);
+    wait_done(&call.done);
+}
+
+// Run fn(arg) on every other CPU, and on this one if self is set,
+// and wait for all of them.
+void smp_call_all(void (*fn)(void *), void *arg, int self)
+{
+    struct ipi_call calls[NCPU];
+    struct cpu *me;
+    int i;
+
+    pushcli();
+    me = mycpu();
+    for (i = 0; i < ncpu; i++)
+    {
+        calls[i].fn = fn;
+        calls[i].arg = arg;
+        calls[i].done = 1;
+        if (&cpus[i] != me)
+        {
+            // Queue without a per-CPU IPI; one broadcast below
+            calls[i].done = 0;
+            acquire(&cpus[i].call_lock);
+            calls[i].next = cpus[i].calls;
+            cpus[i].calls = &calls[i];
+            release(&cpus[i].call_lock);
+        }
+    }
+    if (ncpu > 1)
+        ipi_broadcast(IRQ_CALL);
+    if (self)
+        fn(arg);
+    popcli();
+
+    for (i = 0; i < ncpu; i++)
+        wait_done(&calls[i].done);
+}
+
+// Flush the TLB of every CPU that may hold entries for pgdir (every
+// CPU if pgdir is 0), including this one, after its page table was
+// changed.  Returns once all of them have flushed.
+void tlb_shootdown(pde_t *pgdir)
+{
+    struct cpu *c, *me;
+    uint want[NCPU];
+    int i, sent = 0;
+
+    pushcli();
+    me = mycpu();
+    for (i = 0; i < ncpu; i++)
+    {
+        c = &cpus[i];
+        want[i] = c->tlb_done;
+        if (c == me || (pgdir && (c->proc == 0 || c->proc->pgdir != pgdir)))
+            continue;
+        want[i] = __sync_add_and_fetch(&c->tlb_req, 1);
+        sent++;
+    }
+    if (sent == ncpu - 1 && ncpu > 1)
+        ipi_broadcast(IRQ_TLB);
+    else
+        for (i = 0; i < ncpu; i++)
+            if (want[i] != cpus[i].tlb_done)
+                ipi_send(&cpus[i], IRQ_TLB);
+    lcr3(rcr3());
+
+    // Wait for each target to get at least as far as our request
+    for (i = 0; i < ncpu; i++)
+    {
+        c = &cpus[i];
+        while ((int)(c->tlb_done - want[i]) < 0)
+        {
+            run_calls(me);
+            run_tlb(me);
+        }
+    }
+    popcli();
+}
+
+// Boot-time self-test of the call and flush paths, run by the boot
+// CPU once the others are up.  Panics if any of them misbehaves.
+static int ipitest_ran[NCPU];
+static volatile int ipitest_count;
+
+static void
+ipitest_mark(void *arg)
+{
+    ipitest_ran[cpuid()]++;
+    __sync_fetch_and_add(&ipitest_count, 1);
+}
+
+// Runs on another CPU in its IRQ_CALL handler, and calls back to
+// the boot CPU, which is itself waiting in smp_call() for this one.
+static void
+ipitest_nested(void *arg)
+{
+    smp_call((struct cpu *)arg, ipitest_mark, 0);
+}
+
+void ipitest(void)
+{
+    uint before[NCPU];
+    struct cpu *me;
+    int i;
+
+    if (ncpu < 2)
+        return;
+    me = mycpu();
+
+    // One call to each other CPU
+    for (i = 0; i < ncpu; i++)
+        if (&cpus[i] != me)
+            smp_call(&cpus[i], ipitest_mark, 0);
+    for (i = 0; i < ncpu; i++)
+        if (ipitest_ran[i] != (&cpus[i] != me))
+            panic("ipitest: smp_call");
+
+    // A broadcast call, including this CPU
+    ipitest_count = 0;
+    smp_call_all(ipitest_mark, 0, 1);
+    if (ipitest_count != ncpu)
+        panic("ipitest: smp_call_all");
+
+    // Two CPUs waiting on each other's calls
+    for (i = 0; i < ncpu; i++)
+        if (&cpus[i] != me)
+            break;
+    ipitest_count = 0;
+    smp_call(&cpus[i], ipitest_nested, me);
+    if (ipitest_count != 1 || ipitest_ran[me - cpus] != 2)
+        panic("ipitest: nested smp_call");
+
+    // A flush of every CPU
+    for (i = 0; i < ncpu; i++)
+        before[i] = cpus[i].tlb_done;
+    tlb_shootdown(0);
+    for (i = 0; i < ncpu; i++)
+        if (&cpus[i] != me && cpus[i].tlb_done == before[i])
+            panic("ipitest: tlb_shootdown");
+
+    cprintf("ipi: self-test passed on %d cpus\n", ncpu);
+}
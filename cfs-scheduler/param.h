@@ -0,0 +1,25 @@
+#define NPROC        64  // maximum number of processes
+#define KSTACKSIZE 4096  // size of per-process kernel stack
+#define NCPU          8  // maximum number of CPUs
+#define NOFILE       16  // open files per process
+#define NFILE       100  // open files per system
+#define NINODE       50  // maximum number of active i-nodes
+#define NDEV         10  // maximum major device number
+#define ROOTDEV       1  // device number of file system root disk
+#define MAXARG       32  // max exec arguments
+#define MAXOPBLOCKS  10  // max # of blocks any FS op writes
+#define LOGSIZE      (MAXOPBLOCKS*3)  // max data blocks in on-disk log
+#define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
+#define FSSIZE       1000  // size of file system in blocks
+#define SCHED_LATENCY   6  // ticks in which every runnable process should run once
+#define MIN_GRANULARITY 1  // ticks a process runs before it can be preempted
+#define SLEEPER_CREDIT  3  // max ticks of vruntime credit a waking sleeper gets
+#define NICE_0_WEIGHT 1024 // load weight of a nice 0 process
+#define VRUNTIME_SHIFT  8  // vruntime unit is 2^VRUNTIME_SHIFT TSC cycles
+#define NPRIO          11  // SCHED_PRIO levels, 0 highest (at most 32)
+#define DEFAULT_TICKETS 10 // SCHED_LOTTERY tickets of a new process
+#define MAX_TICKETS 100000 // most tickets one process may hold
+#define DL_BW_SHIFT    16  // SCHED_DEADLINE bandwidth is runtime/period << DL_BW_SHIFT
+#define DL_BW_PERCENT  95  // share of each CPU that SCHED_DEADLINE may reserve
+#define DL_MAX_PERIOD 65535 // longest SCHED_DEADLINE period, in ticks
+#define TIMER_TICR 10000000 // LAPIC timer counts per tick
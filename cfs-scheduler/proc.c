@@ -0,0 +1,954 @@
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "traps.h"
+
+struct ptable ptable;
+static struct proc *initproc;
+
+int nextpid = 1;
+extern void forkret(void);
+extern void trapret(void);
+int context_switches = 0; // Global counter
+static void wakeup1(void *chan);
+
+// SCHED_DEADLINE bandwidth reserved by all processes, and when the
+// next throttled process is due to be replenished.  Protected by
+// ptable.lock.
+static uint dl_total_bw;
+static int dl_throttling;
+static uint dl_next_replenish;
+
+void pinit(void)
+{
+    int i;
+
+    initlock(&ptable.lock, "ptable");
+    for (i = 0; i < ncpu; i++)
+        rq_init(&cpus[i].rq);
+}
+
+// Processes on CPU i other than p: those queued plus the one
+// running, so an idle CPU beats a busy one with as many queued.
+static int
+cpu_load(int i, struct proc *p)
+{
+    return cpus[i].rq.count + (cpus[i].proc && cpus[i].proc != p);
+}
+
+// Choose the runqueue for a process that is becoming RUNNABLE:
+// stay on its previous CPU (warm cache) unless that CPU has
+// more than one process more than the least loaded CPU.
+static int
+pick_cpu(struct proc *p)
+{
+    int i, best = 0;
+
+    for (i = 1; i < ncpu; i++)
+        if (cpu_load(i, p) < cpu_load(best, p))
+            best = i;
+    if (p->cpu >= 0 && p->cpu < ncpu &&
+        cpu_load(p->cpu, p) <= cpu_load(best, p) + 1)
+        return p->cpu;
+    return best;
+}
+
+// Ask CPU c to reschedule if newly queued p should run before
+// its current process: p's class comes first, or the shared
+// class says p should preempt.  The ptable lock must be held.
+static void
+check_preempt(struct cpu *c, struct proc *p)
+{
+    struct proc *curr = c->proc;
+
+    if (curr == 0 || curr == p)
+        return;
+    if (p->policy < curr->policy ||
+        (p->policy == curr->policy &&
+         sched_classes[p->policy]->wakeup_preempt(&c->rq, curr, p)))
+        resched_cpu(c);
+}
+
+// Tell p's class that p stopped running.
+static void
+put_prev(struct proc *p)
+{
+    struct sched_class *class = sched_classes[p->policy];
+
+    if (class->put_prev)
+        class->put_prev(&cpus[p->cpu].rq, p);
+}
+
+// Mark p RUNNABLE and queue it on a CPU.
+// The ptable lock must be held.
+static void
+make_runnable(struct proc *p)
+{
+    int cpu = pick_cpu(p);
+    struct sched_class *class = sched_classes[p->policy];
+    int flags = 0;
+
+    if (p->state == EMBRYO)
+        flags = ENQ_NEW;
+    else if (p->state == SLEEPING)
+        flags = ENQ_WAKEUP;
+
+    if (p->cpu >= 0 && p->cpu != cpu && class->migrate)
+        class->migrate(&cpus[p->cpu].rq, &cpus[cpu].rq, p);
+
+    p->state = RUNNABLE;
+    p->dl_throttled = 0;
+    p->runnable_since = ticks;
+    p->cpu = cpu;
+    rq_add(&cpus[cpu].rq, p, flags);
+    check_preempt(&cpus[cpu], p);
+}
+
+// Return the CPU with the longest runqueue other than c,
+// or 0 if no other CPU has anything queued.  Lock-free
+// peek, so the answer is only a hint.
+static struct cpu *
+busiest_cpu(struct cpu *c)
+{
+    struct cpu *o, *victim = 0;
+
+    for (o = cpus; o < &cpus[ncpu]; o++)
+        if (o != c && o->rq.count > 0 &&
+            (victim == 0 || o->rq.count > victim->rq.count))
+            victim = o;
+    return victim;
+}
+
+// Must be called with interrupts disabled
+int cpuid()
+{
+    return mycpu() - cpus;
+}
+
+// Must be called with interrupts disabled to avoid the caller being
+// rescheduled between reading lapicid and running through the loop.
+struct cpu *
+mycpu(void)
+{
+    int apicid, i;
+
+    if (readeflags() & FL_IF)
+        panic("mycpu called with interrupts enabled\n");
+
+    apicid = lapicid();
+    for (i = 0; i < ncpu; ++i)
+    {
+        if (cpus[i].apicid == apicid)
+            return &cpus[i];
+    }
+    panic("unknown apicid\n");
+}
+
+// Disable interrupts so that we are not rescheduled
+// while reading proc from the cpu structure
+struct proc *
+myproc(void)
+{
+    struct cpu *c;
+    struct proc *p;
+    pushcli();
+    c = mycpu();
+    p = c->proc;
+    popcli();
+    return p;
+}
+
+// PAGEBREAK: 32
+//  Look in the process table for an UNUSED proc.
+//  If found, change state to EMBRYO and initialize
+//  state required to run in the kernel.
+//  Otherwise return 0.
+static struct proc *
+allocproc(void)
+{
+    struct proc *p;
+    char *sp;
+
+    acquire(&ptable.lock);
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+        if (p->state == UNUSED)
+            goto found;
+    release(&ptable.lock);
+    return 0;
+
+found:
+    p->state = EMBRYO;
+    p->pid = nextpid++;
+    p->start_ticks = ticks;
+    p->first_run_ticks = 0;
+    p->run_ticks = 0;
+    p->wait_ticks = 0;
+    p->end_ticks = 0;
+    p->cpu = -1;
+    p->policy = SCHED_FAIR;
+    p->priority = NPRIO - 1;
+    p->tickets = DEFAULT_TICKETS;
+    p->dl_bw = 0;
+    p->dl_budget = 0;
+    p->dl_throttled = 0;
+    p->dl_misses = 0;
+    p->vruntime = 0;
+    p->nice = 0;
+    p->weight = NICE_0_WEIGHT;
+    p->slice_ticks = 0;
+    p->parent = 0;  // Reset parent
+    p->name[0] = 0; // Reset name
+    p->killed = 0;  // Reset killed
+
+    release(&ptable.lock);
+
+    if ((p->kstack = kalloc()) == 0)
+    {
+        p->state = UNUSED;
+        return 0;
+    }
+    sp = p->kstack + KSTACKSIZE;
+    sp -= sizeof *p->tf;
+    p->tf = (struct trapframe *)sp;
+    sp -= 4;
+    *(uint *)sp = (uint)trapret;
+    sp -= sizeof *p->context;
+    p->context = (struct context *)sp;
+    memset(p->context, 0, sizeof *p->context);
+    p->context->eip = (uint)forkret;
+
+    return p;
+}
+
+// PAGEBREAK: 32
+//  Set up first user process.
+void userinit(void)
+{
+    struct proc *p;
+    extern char _binary_initcode_start[], _binary_initcode_size[];
+
+    p = allocproc();
+
+    initproc = p;
+    if ((p->pgdir = setupkvm()) == 0)
+        panic("userinit: out of memory?");
+    inituvm(p->pgdir, _binary_initcode_start, (int)_binary_initcode_size);
+    p->sz = PGSIZE;
+    memset(p->tf, 0, sizeof(*p->tf));
+    p->tf->cs = (SEG_UCODE << 3) | DPL_USER;
+    p->tf->ds = (SEG_UDATA << 3) | DPL_USER;
+    p->tf->es = p->tf->ds;
+    p->tf->ss = p->tf->ds;
+    p->tf->eflags = FL_IF;
+    p->tf->esp = PGSIZE;
+    p->tf->eip = 0; // beginning of initcode.S
+
+    safestrcpy(p->name, "initcode", sizeof(p->name));
+    p->cwd = namei("/");
+
+    acquire(&ptable.lock);
+    make_runnable(p);
+    release(&ptable.lock);
+}
+
+// Grow current process's memory by n bytes.
+// Return 0 on success, -1 on failure.
+int growproc(int n)
+{
+    uint sz;
+    struct proc *curproc = myproc();
+
+    sz = curproc->sz;
+    if (n > 0)
+    {
+        if ((sz = allocuvm(curproc->pgdir, sz, sz + n)) == 0)
+            return -1;
+    }
+    else if (n < 0)
+    {
+        if ((sz = deallocuvm(curproc->pgdir, sz, sz + n)) == 0)
+            return -1;
+    }
+    curproc->sz = sz;
+    switchuvm(curproc);
+    return 0;
+}
+
+// Create a new process copying p as the parent.
+// Sets up stack to return as if from system call.
+// Caller must set state of returned proc to RUNNABLE.
+int fork(void)
+{
+    int i, pid;
+    struct proc *np;
+    struct proc *curproc = myproc();
+
+    if ((np = allocproc()) == 0)
+    {
+        return -1;
+    }
+
+    if ((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0)
+    {
+        kfree(np->kstack);
+        np->kstack = 0;
+        np->state = UNUSED;
+        return -1;
+    }
+    np->sz = curproc->sz;
+    // Bandwidth reservations are not inherited.
+    np->policy = curproc->policy == SCHED_DEADLINE ? SCHED_FAIR : curproc->policy;
+    np->priority = curproc->priority;
+    np->tickets = curproc->tickets;
+    np->nice = curproc->nice;
+    np->weight = curproc->weight;
+    np->parent = curproc;
+    *np->tf = *curproc->tf;
+
+    np->tf->eax = 0;
+
+    for (i = 0; i < NOFILE; i++)
+        if (curproc->ofile[i])
+            np->ofile[i] = filedup(curproc->ofile[i]);
+    np->cwd = idup(curproc->cwd);
+
+    safestrcpy(np->name, curproc->name, sizeof(curproc->name));
+
+    pid = np->pid;
+
+    acquire(&ptable.lock);
+    make_runnable(np);
+    release(&ptable.lock);
+
+    return pid;
+}
+
+// Exit the current process.  Does not return.
+// An exited process remains in the zombie state
+// until its parent calls wait() to find out it exited.
+void exit(void)
+{
+    struct proc *curproc = myproc();
+    struct proc *p;
+    int fd;
+
+    if (curproc == initproc)
+        panic("init exiting");
+
+    curproc->end_ticks = ticks;
+    // cprintf("exit: pid=%d, end_ticks=%d, start_ticks=%d\n", curproc->pid, curproc->end_ticks, curproc->start_ticks);
+
+    for (fd = 0; fd < NOFILE; fd++)
+    {
+        if (curproc->ofile[fd])
+        {
+            fileclose(curproc->ofile[fd]);
+            curproc->ofile[fd] = 0;
+        }
+    }
+
+    begin_op();
+    iput(curproc->cwd);
+    end_op();
+    curproc->cwd = 0;
+
+    acquire(&ptable.lock);
+    wakeup1(curproc->parent);
+
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->parent == curproc)
+        {
+            p->parent = initproc;
+            if (p->state == ZOMBIE)
+                wakeup1(initproc);
+        }
+    }
+
+    if (curproc->policy == SCHED_DEADLINE)
+        dl_total_bw -= curproc->dl_bw;
+    curproc->state = ZOMBIE;
+    sched();
+    panic("zombie exit");
+}
+
+// Wait for a child process to exit and return its pid.
+// Return -1 if this process has no children.
+int wait(void)
+{
+    struct proc *p;
+    int havekids, pid;
+    struct proc *curproc = myproc();
+
+    acquire(&ptable.lock);
+    for (;;)
+    {
+        havekids = 0;
+        // cprintf("wait: curproc=%p (pid=%d)\n", curproc, curproc->pid);
+        for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+        {
+            // cprintf("wait: pid=%d, state=%d, parent=%p\n", p->pid, p->state, p->parent);
+            if (p->parent != curproc)
+            {
+                // cprintf("wait: skipping pid %d, parent=%p, curproc=%p\n", p->pid, p->parent, curproc);
+                continue;
+            }
+            havekids = 1;
+            if (p->state == ZOMBIE)
+            {
+                // cprintf("wait: reaping zombie pid %d\n", p->pid);
+                pid = p->pid;
+                kfree(p->kstack);
+                p->kstack = 0;
+                freevm(p->pgdir);
+                p->state = UNUSED;
+                release(&ptable.lock);
+                return pid;
+            }
+        }
+
+        if (!havekids || curproc->killed)
+        {
+            cprintf("wait: no kids or killed\n");
+            release(&ptable.lock);
+            return -1;
+        }
+
+        // cprintf("wait: sleeping, curproc=%p\n", curproc);
+        sleep(curproc, &ptable.lock);
+    }
+}
+
+// Halt this CPU until the next interrupt: its timer tick, or the
+// IPI kick_idle() sends when work is queued here.  idle is set
+// before the last look at the runqueue, so a CPU queueing work
+// here either sees idle set or has its work seen.
+static void
+idle(struct cpu *c)
+{
+    cli();
+    xchg(&c->idle, 1);
+    if (c->rq.count == 0 && busiest_cpu(c) == 0)
+        sti_hlt();
+    else
+        sti();
+    // The ticks skipped while idle with the tick stopped were idle
+    pushcli();
+    c->idle_ticks += clock_restart();
+    c->idle = 0;
+    popcli();
+}
+
+// Whether this CPU needs its periodic tick.  Not while it is idle
+// or running its only runnable process, unless that process is
+// SCHED_DEADLINE (its budget is charged by the tick) or a throttled
+// SCHED_DEADLINE process is waiting for dl_replenish().
+// Interrupts must be off.
+int sched_tick_needed(void)
+{
+    struct cpu *c = mycpu();
+
+    if (dl_throttling)
+        return 1;
+    if (c->idle)
+        return 0;
+    return c->proc == 0 || c->rq.count != 0 ||
+           c->proc->policy == SCHED_DEADLINE;
+}
+
+// Make c restart its tick if it has stopped it: the IRQ_RESCHED
+// handler calls clock_restart().
+static void
+nohz_kick(struct cpu *c)
+{
+    if (c->tick_stopped)
+        ipi_send(c, IRQ_RESCHED);
+}
+
+// A process has just been queued on rq.  Wake rq's CPU if it is
+// halted in idle(), or restart its tick so it shares the CPU; and
+// if the process has to wait, wake a halted CPU that can steal it.
+// Called with rq->lock held.
+void kick_idle(struct runqueue *rq)
+{
+    struct cpu *c;
+    struct proc *curr = 0;
+
+    __sync_synchronize(); // Order the queue update before reading idle
+    for (c = cpus; c < cpus + ncpu; c++)
+    {
+        if (&c->rq != rq)
+            continue;
+        if (c->idle)
+        {
+            if (rq->count == 1 && c != mycpu())
+                ipi_send(c, IRQ_RESCHED);
+            return;
+        }
+        nohz_kick(c);
+        curr = c->proc;
+    }
+    // It waits if another is queued ahead of it or rq's CPU keeps
+    // running its process (a yielding one is RUNNABLE already)
+    if (rq->count < 2 && (curr == 0 || curr->state != RUNNING))
+        return;
+    for (c = cpus; c < cpus + ncpu; c++)
+        if (c != mycpu() && c->idle)
+        {
+            ipi_send(c, IRQ_RESCHED);
+            return;
+        }
+}
+
+// PAGEBREAK: 42
+//  Per-CPU process scheduler.
+//  Each CPU calls scheduler() after setting itself up.
+//  Scheduler never returns.  It loops, doing:
+//   - choose a process to run
+//   - swtch to start running that process
+//   - eventually that process transfers control
+//       via swtch back to the scheduler.
+//  Each CPU runs the next process of the first scheduling class
+//  with anything queued on its own runqueue and, when that is
+//  empty, steals from the CPU with the longest queue.
+void scheduler(void)
+{
+    struct proc *p;
+    struct cpu *c = mycpu();
+    struct cpu *victim;
+    c->proc = 0;
+
+    for (;;)
+    {
+        sti();
+
+        // Nothing queued here or elsewhere: halt until there is.
+        if (c->rq.count == 0 && busiest_cpu(c) == 0)
+        {
+            idle(c);
+            continue;
+        }
+
+        acquire(&ptable.lock);
+        p = rq_select(&c->rq);
+        if (p == 0 && (victim = busiest_cpu(c)) != 0)
+        {
+            p = rq_select(&victim->rq);
+            if (p && sched_classes[p->policy]->migrate)
+                sched_classes[p->policy]->migrate(&victim->rq, &c->rq, p);
+        }
+        if (p == 0)
+        {
+            release(&ptable.lock);
+            continue;
+        }
+        if (p->state != RUNNABLE)
+            panic("scheduler: queued proc not runnable");
+
+        p->cpu = c - cpus;
+        p->wait_ticks += ticks - p->runnable_since;
+        if (sched_classes[p->policy]->set_curr)
+            sched_classes[p->policy]->set_curr(&c->rq, p);
+        c->need_resched = 0;
+        c->proc = p;
+        switchuvm(p);
+        if (p->first_run_ticks == 0)
+            p->first_run_ticks = ticks;
+        p->state = RUNNING;
+        context_switches++;
+        swtch(&(c->scheduler), p->context);
+        switchkvm();
+        c->proc = 0;
+        release(&ptable.lock);
+    }
+}
+
+// Enter scheduler.  Must hold only ptable.lock
+// and have changed proc->state. Saves and restores
+// intena because intena is a property of this
+// kernel thread, not this CPU. It should
+// be proc->intena and proc->ncli, but that would
+// break in the few places where a lock is held but
+// there's no process.
+void sched(void)
+{
+    int intena;
+    struct proc *p = myproc();
+
+    if (!holding(&ptable.lock))
+        panic("sched ptable.lock");
+    if (mycpu()->ncli != 1)
+        panic("sched locks");
+    if (p->state == RUNNING)
+        panic("sched running");
+    if (readeflags() & FL_IF)
+        panic("sched interruptible");
+    intena = mycpu()->intena;
+    swtch(&p->context, mycpu()->scheduler);
+    mycpu()->intena = intena;
+}
+
+// Give up the CPU for one scheduling round.
+void yield(void)
+{
+    struct proc *curproc = myproc();
+    acquire(&ptable.lock);
+    put_prev(curproc);
+    if (curproc->dl_throttled)
+    {
+        // Out of SCHED_DEADLINE budget: sleep until dl_replenish()
+        // starts the next period.
+        uint due = curproc->dl_release + curproc->dl_period;
+
+        if (!dl_throttling || dl_time_before(due, dl_next_replenish))
+            dl_next_replenish = due;
+        dl_throttling = 1;
+        curproc->chan = &curproc->dl_throttled;
+        curproc->state = SLEEPING;
+        sched();
+        curproc->chan = 0;
+    }
+    else
+    {
+        make_runnable(curproc);
+        sched();
+    }
+    release(&ptable.lock);
+}
+
+// A fork child's very first scheduling by scheduler()
+// will swtch here.  "Return" to user space.
+void forkret(void)
+{
+    static int first = 1;
+    release(&ptable.lock);
+
+    if (first)
+    {
+        first = 0;
+        iinit(ROOTDEV);
+        initlog(ROOTDEV);
+    }
+}
+
+// Atomically release lock and sleep on chan.
+// Reacquires lock when awakened.
+void sleep(void *chan, struct spinlock *lk)
+{
+    struct proc *p = myproc();
+
+    if (p == 0)
+        panic("sleep");
+
+    if (lk == 0)
+        panic("sleep without lk");
+
+    if (lk != &ptable.lock)
+    {
+        acquire(&ptable.lock);
+        release(lk);
+    }
+    p->chan = chan;
+    p->state = SLEEPING;
+    put_prev(p);
+
+    // Debug: Print the entire process table
+    // cprintf("Process table state:\n");
+    for (struct proc *proc = ptable.proc; proc < &ptable.proc[NPROC]; proc++)
+    {
+        if (proc->state != UNUSED)
+        {
+            // cprintf("PID %d: state=%d, name=%s\n", proc->pid, proc->state, proc->name);
+        }
+    }
+
+    sched();
+
+    p->chan = 0;
+
+    if (lk != &ptable.lock)
+    {
+        release(&ptable.lock);
+        acquire(lk);
+    }
+}
+
+// PAGEBREAK!
+//  Wake up all processes sleeping on chan.
+//  The ptable lock must be held.
+static void wakeup1(void *chan)
+{
+    struct proc *p;
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->state == SLEEPING && p->chan == chan)
+        {
+            make_runnable(p);
+        }
+    }
+}
+
+// Wake up all processes sleeping on chan.
+void wakeup(void *chan)
+{
+    acquire(&ptable.lock);
+    wakeup1(chan);
+    release(&ptable.lock);
+}
+
+// Kill the process with the given pid.
+// Process won't exit until it returns
+// to user space (see trap in trap.c).
+int kill(int pid)
+{
+    struct proc *p;
+
+    acquire(&ptable.lock);
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->pid == pid)
+        {
+            p->killed = 1;
+            if (p->state == SLEEPING)
+                make_runnable(p);
+            else if (p->state == RUNNING)
+                resched_cpu(&cpus[p->cpu]); // Its tick may be stopped
+            release(&ptable.lock);
+            return 0;
+        }
+    }
+    release(&ptable.lock);
+    return -1;
+}
+
+// PAGEBREAK: 36
+//  Print a process listing to console.  For debugging.
+//  Runs when user types ^P on console.
+//  No lock to avoid wedging a stuck machine further.
+void procdump(void)
+{
+    static char *states[] = {
+        [UNUSED] "unused",
+        [EMBRYO] "embryo",
+        [SLEEPING] "sleep ",
+        [RUNNABLE] "runble",
+        [RUNNING] "run   ",
+        [ZOMBIE] "zombie"};
+    int i;
+    struct proc *p;
+    char *state;
+    uint pc[10];
+
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->state == UNUSED)
+            continue;
+        if (p->state >= 0 && p->state < NELEM(states) && states[p->state])
+            state = states[p->state];
+        else
+            state = "???";
+        cprintf("%d %s %s", p->pid, state, p->name);
+        if (p->state == SLEEPING)
+        {
+            getcallerpcs((uint *)p->context->ebp + 2, pc);
+            for (i = 0; i < 10 && pc[i] != 0; i++)
+                cprintf(" %p", pc[i]);
+        }
+        cprintf("\n");
+    }
+    for (i = 0; i < ncpu; i++)
+        cprintf("cpu%d: idle %d ticks\n", i, cpus[i].idle_ticks);
+}
+
+// Charge the running process for a timer tick and decide whether
+// it should give up the CPU: when a higher scheduling class has
+// work queued here, or when its own class says so.
+// Called with interrupts disabled.
+int sched_tick(struct proc *p)
+{
+    struct runqueue *rq = &mycpu()->rq;
+    int i, preempt = 0;
+
+    acquire(&rq->lock);
+    for (i = 0; i < p->policy; i++)
+        if (rq->nr[i])
+            preempt = 1;
+    if (sched_classes[p->policy]->tick(rq, p))
+        preempt = 1;
+    release(&rq->lock);
+    return preempt;
+}
+
+// Move p to scheduling class policy with class parameter param
+// (priority for SCHED_PRIO, nice for SCHED_FAIR, tickets for
+// SCHED_LOTTERY).  The ptable lock must be held.
+static void
+change_sched(struct proc *p, int policy, int param)
+{
+    int queued = p->state == RUNNABLE;
+    int moved = policy != p->policy;
+
+    // Take p out of its old class first so it is charged and
+    // dequeued with the parameters it was queued with.
+    if (queued)
+        rq_remove(&cpus[p->cpu].rq, p);
+    else if (p->state == RUNNING)
+        put_prev(p);
+
+    if (moved && p->policy == SCHED_DEADLINE)
+        dl_total_bw -= p->dl_bw;
+    if (moved && policy == SCHED_FAIR && p->cpu >= 0)
+        p->vruntime = cpus[p->cpu].rq.fair.min_vruntime;
+    p->policy = policy;
+    if (policy == SCHED_PRIO)
+        p->priority = param;
+    else if (policy == SCHED_FAIR)
+    {
+        p->nice = param;
+        p->weight = nice_weight(param);
+    }
+    else if (policy == SCHED_LOTTERY)
+        p->tickets = param;
+
+    if (queued)
+    {
+        rq_add(&cpus[p->cpu].rq, p, moved ? ENQ_NEW : 0);
+        check_preempt(&cpus[p->cpu], p);
+    }
+    else if (p->state == RUNNING)
+    {
+        if (sched_classes[policy]->set_curr)
+            sched_classes[policy]->set_curr(&cpus[p->cpu].rq, p);
+        resched_cpu(&cpus[p->cpu]); // Re-evaluate against the new class
+        nohz_kick(&cpus[p->cpu]);   // SCHED_DEADLINE needs the tick
+    }
+}
+
+// Put process pid in scheduling class policy with parameter
+// param.  Return 0, or -1 if there is no such process or the
+// policy or parameter is invalid.
+int sched_setpolicy(int pid, int policy, int param)
+{
+    struct proc *p;
+
+    if (policy == SCHED_PRIO && (param < 0 || param >= NPRIO))
+        return -1;
+    if (policy == SCHED_FAIR && (param < -20 || param > 19))
+        return -1;
+    if (policy == SCHED_LOTTERY && (param < 1 || param > MAX_TICKETS))
+        return -1;
+    if (policy < 0 || policy >= NSCHED || policy == SCHED_DEADLINE)
+        return -1;
+
+    acquire(&ptable.lock);
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->pid == pid && p->state != UNUSED && p->state != ZOMBIE)
+        {
+            change_sched(p, policy, param);
+            release(&ptable.lock);
+            return 0;
+        }
+    }
+    release(&ptable.lock);
+    return -1;
+}
+
+// Move the calling process to SCHED_DEADLINE, reserving runtime
+// ticks in every period ticks, to be used within deadline ticks of
+// the start of each period.  Return 0, or -1 if the parameters are
+// invalid or the reservation would take SCHED_DEADLINE past
+// DL_BW_PERCENT of the machine's CPUs.
+int sched_setdeadline(int runtime, int period, int deadline)
+{
+    struct proc *p = myproc();
+    uint bw, old;
+
+    if (runtime <= 0 || runtime > deadline || deadline > period || period > DL_MAX_PERIOD)
+        return -1;
+    bw = ((uint)runtime << DL_BW_SHIFT) / period;
+
+    acquire(&ptable.lock);
+    old = p->policy == SCHED_DEADLINE ? p->dl_bw : 0;
+    if (dl_total_bw - old + bw > ncpu * ((DL_BW_PERCENT << DL_BW_SHIFT) / 100))
+    {
+        release(&ptable.lock);
+        return -1;
+    }
+    dl_total_bw = dl_total_bw - old + bw;
+    p->dl_bw = bw;
+    p->dl_runtime = runtime;
+    p->dl_period = period;
+    p->dl_deadline = deadline;
+    p->dl_release = ticks;
+    p->dl_abs_deadline = ticks + deadline;
+    p->dl_budget = runtime;
+    change_sched(p, SCHED_DEADLINE, 0);
+    release(&ptable.lock);
+    return 0;
+}
+
+// Wake throttled SCHED_DEADLINE processes whose next period has
+// begun.  Called on every timer tick, by whichever CPUs are ticking.
+void dl_replenish(void)
+{
+    struct proc *p;
+    uint due;
+
+    // Cheap check without the lock; a stale answer only delays
+    // replenishment to the next tick.
+    if (!dl_throttling || dl_time_before(ticks, dl_next_replenish))
+        return;
+
+    acquire(&ptable.lock);
+    dl_throttling = 0;
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->state != SLEEPING || !p->dl_throttled)
+            continue;
+        due = p->dl_release + p->dl_period;
+        if (!dl_time_before(ticks, due))
+            make_runnable(p);
+        else if (!dl_throttling || dl_time_before(due, dl_next_replenish))
+        {
+            dl_next_replenish = due;
+            dl_throttling = 1;
+        }
+    }
+    release(&ptable.lock);
+}
+
+// Set the nice value of process pid.  Return 0, or -1 if
+// there is no such process or nice is out of range.
+int setnice(int pid, int nice)
+{
+    struct proc *p;
+
+    if (nice < -20 || nice > 19)
+        return -1;
+
+    acquire(&ptable.lock);
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->pid == pid && p->state != UNUSED)
+        {
+            if (p->policy == SCHED_FAIR && p->state != ZOMBIE)
+                change_sched(p, SCHED_FAIR, nice);
+            else
+            {
+                // Takes effect if p later joins SCHED_FAIR
+                p->nice = nice;
+                p->weight = nice_weight(nice);
+            }
+            release(&ptable.lock);
+            return 0;
+        }
+    }
+    release(&ptable.lock);
+    return -1;
+}
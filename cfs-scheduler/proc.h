@@ -0,0 +1,152 @@
+#ifndef _PROC_H_
+#define _PROC_H_
+
+#include "types.h"
+#include "param.h"    // For NPROC, NCPU, NOFILE
+#include "spinlock.h" // For struct spinlock in ptable
+#include "runqueue.h" // For the per-CPU runqueue
+
+// Forward declarations
+struct taskstate; // From mmu.h
+struct segdesc;   // From mmu.h
+struct trapframe; // From traps.h
+struct file;      // From file.h
+struct inode;     // From file.h
+
+extern int context_switches; // Declare global variable
+
+// Per-CPU state
+struct cpu
+{
+    uchar apicid;              // Local APIC ID
+    struct context *scheduler; // swtch() here to enter scheduler
+    struct taskstate ts;       // Used by x86 to find stack for interrupt
+    struct segdesc gdt[NSEGS]; // x86 global descriptor table
+    volatile uint started;     // Has the CPU started?
+    int ncli;                  // Depth of pushcli nesting.
+    int intena;                // Were interrupts enabled before pushcli?
+    struct proc *proc;         // The process running on this cpu or null
+    struct runqueue rq;        // RUNNABLE processes waiting for this cpu
+    volatile uint idle;        // Halted in the idle loop
+    uint idle_ticks;           // Timer ticks spent idle
+    volatile int tick_stopped; // NOHZ: no periodic tick programmed
+    uint last_tick_tsc;        // TSC at the previous timer interrupt
+    uint tick_tsc;             // TSC cycles in the last timer tick
+    volatile int need_resched; // Preempt the running process at the next trap
+    struct spinlock call_lock; // Protects calls
+    struct ipi_call *calls;    // Functions queued for this CPU by smp_call()
+    volatile uint tlb_req;     // TLB flushes requested of this CPU
+    volatile uint tlb_done;    // tlb_req value at the last flush
+};
+// A function for another CPU to run, queued by smp_call()
+struct ipi_call
+{
+    void (*fn)(void *);
+    void *arg;
+    volatile int done;    // Set once fn has returned
+    struct ipi_call *next;
+};
+
+extern struct cpu cpus[NCPU];
+extern int ncpu;
+
+// Saved registers for kernel context switches
+struct context
+{
+    uint edi;
+    uint esi;
+    uint ebx;
+    uint ebp;
+    uint eip;
+};
+
+enum procstate
+{
+    UNUSED,
+    EMBRYO,
+    SLEEPING,
+    RUNNABLE,
+    RUNNING,
+    ZOMBIE
+};
+
+// Per-process state
+struct proc
+{
+    uint sz;                    // Size of process memory (bytes)
+    pde_t *pgdir;               // Page table
+    char *kstack;               // Bottom of kernel stack for this process
+    enum procstate state;       // Process state
+    int pid;                    // Process ID
+    struct proc *parent;        // Parent process
+    struct trapframe *tf;       // Trap frame for current syscall
+    struct context *context;    // swtch() here to run process
+    void *chan;                 // If non-zero, sleeping on chan
+    int killed;                 // If non-zero, have been killed
+    struct file *ofile[NOFILE]; // Open files
+    struct inode *cwd;          // Current directory
+    char name[16];              // Process name (debugging)
+    int start_ticks;            // Creation time (for timingtests)
+    int first_run_ticks;        // First run time
+    int run_ticks;              // Total CPU time
+    int wait_ticks;             // Total waiting time in RUNNABLE state
+    int end_ticks;              // Completion time
+    int policy;                 // Scheduling class (SCHED_*)
+    int priority;               // SCHED_PRIO level, 0 (highest) to NPRIO-1
+    int tickets;                // SCHED_LOTTERY tickets
+    uint dl_runtime;            // SCHED_DEADLINE: ticks reserved per period
+    uint dl_period;             //   period length in ticks
+    uint dl_deadline;           //   deadline relative to the period's start
+    uint dl_bw;                 //   reserved bandwidth (see DL_BW_SHIFT)
+    uint dl_release;            //   start of the current period
+    uint dl_abs_deadline;       //   absolute deadline of the current period
+    int dl_budget;              //   ticks of runtime left in this period
+    int dl_throttled;           //   Budget used up; sleeping until next period
+    int dl_misses;              //   Deadlines missed
+    struct rb_node rb;          // SCHED_FAIR node in the runqueue's vruntime tree
+    struct proc *next;          // Next process in a FIFO class queue
+    struct proc *prev;          // Previous process in a FIFO class queue
+    int cpu;                    // CPU whose runqueue holds or last held the process
+    uint runnable_since;        // Tick the process last became RUNNABLE
+    uint vruntime;              // Weighted run time, in the frame of p->cpu's runqueue
+    int nice;                   // Nice value, -20 (most CPU) to 19
+    uint weight;                // Load weight for nice; NICE_0_WEIGHT at nice 0
+    uint64 exec_start;          // TSC when run time was last charged
+    int slice_ticks;            // Ticks run since last picked
+};
+
+// Process table structure
+struct ptable
+{
+    struct spinlock lock; // Actual spinlock instance
+    struct proc proc[NPROC];
+};
+extern struct ptable ptable; // Global process table
+
+// Process stats for getpinfo
+struct proc_stat
+{
+    int pid;
+    int turnaround; // end_ticks - start_ticks
+    int response;   // first_run_ticks - start_ticks
+    int waiting;    // wait_ticks
+    int cpu;        // run_ticks
+    int dl_misses;  // SCHED_DEADLINE deadlines missed
+};
+
+// Function declarations
+void pinit(void);
+int cpuid(void);
+struct cpu *mycpu(void);
+struct proc *myproc(void);
+int fork(void);
+void scheduler(void);
+void sched(void);
+void yield(void);
+void forkret(void);
+void sleep(void *, struct spinlock *);
+void wakeup(void *);
+int kill(int);
+void procdump(void);
+
+#endif
\ No newline at end of file
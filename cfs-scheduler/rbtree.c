@@ -0,0 +1,271 @@
+// Red-black tree (CLRS, with null leaves instead of a sentinel).
+// Insert and erase are O(log n) and never allocate.
+
+#include "types.h"
+#include "rbtree.h"
+
+static void
+rotate_left(struct rb_root *root, struct rb_node *x)
+{
+    struct rb_node *y = x->right;
+
+    x->right = y->left;
+    if (y->left)
+        y->left->parent = x;
+    y->parent = x->parent;
+    if (x->parent == 0)
+        root->node = y;
+    else if (x == x->parent->left)
+        x->parent->left = y;
+    else
+        x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+}
+
+static void
+rotate_right(struct rb_root *root, struct rb_node *x)
+{
+    struct rb_node *y = x->left;
+
+    x->left = y->right;
+    if (y->right)
+        y->right->parent = x;
+    y->parent = x->parent;
+    if (x->parent == 0)
+        root->node = y;
+    else if (x == x->parent->right)
+        x->parent->right = y;
+    else
+        x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+}
+
+static int
+is_black(struct rb_node *n)
+{
+    return n == 0 || n->color == RB_BLACK;
+}
+
+// Restore the red-black properties after linking a new red node.
+void rb_insert_color(struct rb_node *z, struct rb_root *root)
+{
+    struct rb_node *p, *g, *u;
+
+    while ((p = z->parent) && p->color == RB_RED)
+    {
+        g = p->parent; // p is red, so it is not the root
+        if (p == g->left)
+        {
+            u = g->right;
+            if (!is_black(u))
+            {
+                p->color = RB_BLACK;
+                u->color = RB_BLACK;
+                g->color = RB_RED;
+                z = g;
+                continue;
+            }
+            if (z == p->right)
+            {
+                rotate_left(root, p);
+                z = p;
+                p = z->parent;
+            }
+            p->color = RB_BLACK;
+            g->color = RB_RED;
+            rotate_right(root, g);
+        }
+        else
+        {
+            u = g->left;
+            if (!is_black(u))
+            {
+                p->color = RB_BLACK;
+                u->color = RB_BLACK;
+                g->color = RB_RED;
+                z = g;
+                continue;
+            }
+            if (z == p->left)
+            {
+                rotate_right(root, p);
+                z = p;
+                p = z->parent;
+            }
+            p->color = RB_BLACK;
+            g->color = RB_RED;
+            rotate_left(root, g);
+        }
+    }
+    root->node->color = RB_BLACK;
+}
+
+// Replace the subtree rooted at u with the one rooted at v.
+static void
+transplant(struct rb_root *root, struct rb_node *u, struct rb_node *v)
+{
+    if (u->parent == 0)
+        root->node = v;
+    else if (u == u->parent->left)
+        u->parent->left = v;
+    else
+        u->parent->right = v;
+    if (v)
+        v->parent = u->parent;
+}
+
+// Fix a double-black at x (possibly null) whose parent is xp.
+static void
+erase_fixup(struct rb_root *root, struct rb_node *x, struct rb_node *xp)
+{
+    struct rb_node *w;
+
+    while (x != root->node && is_black(x))
+    {
+        if (x == xp->left)
+        {
+            w = xp->right;
+            if (w->color == RB_RED)
+            {
+                w->color = RB_BLACK;
+                xp->color = RB_RED;
+                rotate_left(root, xp);
+                w = xp->right;
+            }
+            if (is_black(w->left) && is_black(w->right))
+            {
+                w->color = RB_RED;
+                x = xp;
+                xp = x->parent;
+            }
+            else
+            {
+                if (is_black(w->right))
+                {
+                    w->left->color = RB_BLACK;
+                    w->color = RB_RED;
+                    rotate_right(root, w);
+                    w = xp->right;
+                }
+                w->color = xp->color;
+                xp->color = RB_BLACK;
+                w->right->color = RB_BLACK;
+                rotate_left(root, xp);
+                x = root->node;
+            }
+        }
+        else
+        {
+            w = xp->left;
+            if (w->color == RB_RED)
+            {
+                w->color = RB_BLACK;
+                xp->color = RB_RED;
+                rotate_right(root, xp);
+                w = xp->left;
+            }
+            if (is_black(w->right) && is_black(w->left))
+            {
+                w->color = RB_RED;
+                x = xp;
+                xp = x->parent;
+            }
+            else
+            {
+                if (is_black(w->left))
+                {
+                    w->right->color = RB_BLACK;
+                    w->color = RB_RED;
+                    rotate_left(root, w);
+                    w = xp->left;
+                }
+                w->color = xp->color;
+                xp->color = RB_BLACK;
+                w->left->color = RB_BLACK;
+                rotate_right(root, xp);
+                x = root->node;
+            }
+        }
+    }
+    if (x)
+        x->color = RB_BLACK;
+}
+
+// Unlink z from the tree and rebalance.
+void rb_erase(struct rb_node *z, struct rb_root *root)
+{
+    struct rb_node *y = z, *x, *xp;
+    int ycolor = y->color;
+
+    if (z->left == 0)
+    {
+        x = z->right;
+        xp = z->parent;
+        transplant(root, z, z->right);
+    }
+    else if (z->right == 0)
+    {
+        x = z->left;
+        xp = z->parent;
+        transplant(root, z, z->left);
+    }
+    else
+    {
+        // Splice out z's successor y and put it in z's place
+        y = z->right;
+        while (y->left)
+            y = y->left;
+        ycolor = y->color;
+        x = y->right;
+        if (y->parent == z)
+            xp = y;
+        else
+        {
+            xp = y->parent;
+            transplant(root, y, y->right);
+            y->right = z->right;
+            y->right->parent = y;
+        }
+        transplant(root, z, y);
+        y->left = z->left;
+        y->left->parent = y;
+        y->color = z->color;
+    }
+
+    if (ycolor == RB_BLACK)
+        erase_fixup(root, x, xp);
+    z->parent = z->left = z->right = 0;
+}
+
+// Smallest node, or 0 if the tree is empty.
+struct rb_node *
+rb_first(struct rb_root *root)
+{
+    struct rb_node *n = root->node;
+
+    if (n == 0)
+        return 0;
+    while (n->left)
+        n = n->left;
+    return n;
+}
+
+// In-order successor of n, or 0 if n is the largest node.
+struct rb_node *
+rb_next(struct rb_node *n)
+{
+    struct rb_node *p;
+
+    if (n->right)
+    {
+        n = n->right;
+        while (n->left)
+            n = n->left;
+        return n;
+    }
+    while ((p = n->parent) && n == p->right)
+        n = p;
+    return p;
+}
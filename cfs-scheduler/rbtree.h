@@ -0,0 +1,42 @@
+#ifndef _RBTREE_H_
+#define _RBTREE_H_
+
+// Intrusive red-black tree.  A node is embedded in the structure it
+// orders; callers walk down from the root to find the link to fill,
+// call rb_link_node() and then rb_insert_color() to rebalance.
+
+#define RB_RED   0
+#define RB_BLACK 1
+
+struct rb_node
+{
+    struct rb_node *parent;
+    struct rb_node *left;
+    struct rb_node *right;
+    int color;
+};
+
+struct rb_root
+{
+    struct rb_node *node;
+};
+
+// Containing structure of an embedded node
+#define rb_entry(ptr, type, member) \
+    ((type *)((char *)(ptr) - (uint)&((type *)0)->member))
+
+static inline void
+rb_link_node(struct rb_node *node, struct rb_node *parent, struct rb_node **link)
+{
+    node->parent = parent;
+    node->left = node->right = 0;
+    node->color = RB_RED;
+    *link = node;
+}
+
+void rb_insert_color(struct rb_node *node, struct rb_root *root);
+void rb_erase(struct rb_node *node, struct rb_root *root);
+struct rb_node *rb_first(struct rb_root *root);
+struct rb_node *rb_next(struct rb_node *node);
+
+#endif // _RBTREE_H_
@@ -0,0 +1,102 @@
+// Per-CPU runqueues.
+// A runqueue holds one queue per scheduling class; these functions
+// dispatch to the process's class and keep the per-class counts that
+// give the strict class order (see sched.h).
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "runqueue.h"
+
+// Classes in the order they are tried; indexed by SCHED_*.
+struct sched_class *sched_classes[NSCHED] = {
+    [SCHED_DEADLINE] &deadline_sched_class,
+    [SCHED_PRIO] &prio_sched_class,
+    [SCHED_RR] &rr_sched_class,
+    [SCHED_FAIR] &fair_sched_class,
+    [SCHED_LOTTERY] &lottery_sched_class,
+};
+
+void rq_init(struct runqueue *rq)
+{
+    int i;
+
+    initlock(&rq->lock, "runqueue");
+    rq->count = 0;
+    for (i = 0; i < NSCHED; i++)
+    {
+        rq->nr[i] = 0;
+        sched_classes[i]->init(rq);
+    }
+}
+
+// Queue p in its class.
+void rq_add(struct runqueue *rq, struct proc *p, int flags)
+{
+    acquire(&rq->lock);
+    sched_classes[p->policy]->enqueue(rq, p, flags);
+    rq->nr[p->policy]++;
+    rq->count++;
+    kick_idle(rq); // Its CPU may be halted or tickless
+    release(&rq->lock);
+}
+
+// Take queued process p off rq.
+void rq_remove(struct runqueue *rq, struct proc *p)
+{
+    acquire(&rq->lock);
+    sched_classes[p->policy]->dequeue(rq, p);
+    rq->nr[p->policy]--;
+    rq->count--;
+    release(&rq->lock);
+}
+
+// Remove and return the next process to run: the pick of the
+// first class with anything queued, or 0 if rq is empty.
+struct proc *
+rq_select(struct runqueue *rq)
+{
+    struct proc *p = 0;
+    int i;
+
+    acquire(&rq->lock);
+    for (i = 0; i < NSCHED; i++)
+    {
+        if (rq->nr[i] == 0)
+            continue;
+        p = sched_classes[i]->pick_next(rq);
+        rq->nr[i]--;
+        rq->count--;
+        break;
+    }
+    release(&rq->lock);
+    return p;
+}
+
+// Append p to the tail of q.
+void fifo_push(struct fifo_rq *q, struct proc *p)
+{
+    p->next = 0;
+    p->prev = q->tail;
+    if (q->tail)
+        q->tail->next = p;
+    else
+        q->head = p;
+    q->tail = p;
+}
+
+// Unlink p from q.
+void fifo_unlink(struct fifo_rq *q, struct proc *p)
+{
+    if (p->prev)
+        p->prev->next = p->next;
+    else
+        q->head = p->next;
+    if (p->next)
+        p->next->prev = p->prev;
+    else
+        q->tail = p->prev;
+    p->next = p->prev = 0;
+}
@@ -0,0 +1,77 @@
+#ifndef _RUNQUEUE_H_
+#define _RUNQUEUE_H_
+
+#include "spinlock.h"
+#include "rbtree.h"
+#include "sched.h"
+
+struct proc;
+
+// SCHED_FAIR: processes in a red-black tree ordered by vruntime,
+// with the leftmost (next to run) node cached.
+struct fair_rq
+{
+    struct rb_root tree;      // Queued processes keyed by vruntime
+    struct rb_node *leftmost; // Node with the smallest vruntime, or 0
+    uint min_vruntime;        // Monotonic floor of vruntime on this CPU
+    uint load;                // Sum of the weights of queued processes
+};
+
+// SCHED_DEADLINE: processes in a red-black tree ordered by
+// absolute deadline, with the leftmost node cached.
+struct dl_rq
+{
+    struct rb_root tree;      // Queued processes keyed by dl_abs_deadline
+    struct rb_node *leftmost; // Node with the earliest deadline, or 0
+};
+
+// SCHED_RR, SCHED_LOTTERY and each SCHED_PRIO level: a FIFO
+// linked through proc->next/prev.
+struct fifo_rq
+{
+    struct proc *head;
+    struct proc *tail;
+};
+
+// SCHED_PRIO: a FIFO per level and a bitmap of non-empty levels.
+struct prio_rq
+{
+    struct fifo_rq level[NPRIO];
+    uint bitmap; // Bit i set while level i is non-empty
+};
+
+struct lottery_rq
+{
+    struct fifo_rq queue;
+    uint total_tickets; // Sum of the tickets of queued processes
+    uint rand_state;    // xorshift32 state for drawing winners
+};
+
+// Per-CPU runqueue: one queue per scheduling class.
+struct runqueue
+{
+    struct spinlock lock;  // Protects every class queue below
+    int count;             // Number of queued processes, all classes
+    int nr[NSCHED];        // Number of queued processes per class
+    struct dl_rq dl;
+    struct prio_rq prio;
+    struct fifo_rq rr;
+    struct fair_rq fair;
+    struct lottery_rq lottery;
+};
+
+// Compare vruntimes so that wraparound of the 32-bit clock is harmless
+#define vruntime_before(a, b) ((int)((a) - (b)) < 0)
+// Same for times in ticks
+#define dl_time_before(a, b) ((int)((a) - (b)) < 0)
+
+void rq_init(struct runqueue *rq);
+void rq_add(struct runqueue *rq, struct proc *p, int flags);
+void rq_remove(struct runqueue *rq, struct proc *p);
+struct proc *rq_select(struct runqueue *rq);
+
+// FIFO helpers shared by the list-based classes
+void fifo_push(struct fifo_rq *q, struct proc *p);
+void fifo_unlink(struct fifo_rq *q, struct proc *p);
+
+#endif // _RUNQUEUE_H_
@@ -0,0 +1,54 @@
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+// Scheduling classes.  Every process belongs to one class, chosen
+// with sched_setpolicy() or sched_setdeadline().  Classes are
+// strictly ordered: a CPU only runs a class when every class before
+// it has nothing queued there.
+#define SCHED_DEADLINE 0 // Earliest deadline first with reserved bandwidth
+#define SCHED_PRIO     1 // Fixed priority 0..NPRIO-1 (0 highest), FIFO within a level
+#define SCHED_RR       2 // Round-robin with one-tick slices
+#define SCHED_FAIR     3 // Completely fair: vruntime weighted by nice
+#define SCHED_LOTTERY  4 // Proportional share by lottery tickets
+#define NSCHED         5
+
+// Why a process is being enqueued
+#define ENQ_NEW    1 // Newly created, or just moved into this class
+#define ENQ_WAKEUP 2 // Was sleeping
+
+struct runqueue;
+struct proc;
+
+// Operations a scheduling class provides.  All but wakeup_preempt
+// are called with the runqueue's lock held; enqueue/dequeue/pick_next
+// need not update the runqueue's counts, rq_add/rq_remove/rq_select
+// do that.  set_curr, put_prev and migrate may be 0.
+struct sched_class
+{
+    char *name;
+    void (*init)(struct runqueue *rq);
+    void (*enqueue)(struct runqueue *rq, struct proc *p, int flags);
+    void (*dequeue)(struct runqueue *rq, struct proc *p);
+    // Remove and return the process this class would run next.
+    struct proc *(*pick_next)(struct runqueue *rq);
+    // Charge the running process p for a tick; return 1 to preempt it.
+    int (*tick)(struct runqueue *rq, struct proc *p);
+    // Should newly queued p preempt curr (both in this class)?
+    int (*wakeup_preempt)(struct runqueue *rq, struct proc *curr, struct proc *p);
+    // p starts running / stops running on rq's CPU.
+    void (*set_curr)(struct runqueue *rq, struct proc *p);
+    void (*put_prev)(struct runqueue *rq, struct proc *p);
+    // p moves from one CPU's runqueue to another's (optional).
+    void (*migrate)(struct runqueue *from, struct runqueue *to, struct proc *p);
+};
+
+extern struct sched_class deadline_sched_class;
+extern struct sched_class prio_sched_class;
+extern struct sched_class rr_sched_class;
+extern struct sched_class fair_sched_class;
+extern struct sched_class lottery_sched_class;
+extern struct sched_class *sched_classes[NSCHED];
+
+uint nice_weight(int nice);
+
+#endif // _SCHED_H_
@@ -0,0 +1,153 @@
+// SCHED_DEADLINE: earliest deadline first with a constant
+// bandwidth server per process.
+// A process reserves dl_runtime ticks in every dl_period ticks,
+// to be used within dl_deadline ticks of the period's start.  The
+// queued process with the earliest absolute deadline runs next.
+// A process that uses up its budget is throttled (see yield() and
+// dl_replenish() in proc.c) until its next period begins.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "runqueue.h"
+
+// Start a new period for p at time now with a full budget.
+static void
+dl_new_period(struct proc *p, uint now)
+{
+    p->dl_release = now;
+    p->dl_abs_deadline = now + p->dl_deadline;
+    p->dl_budget = p->dl_runtime;
+}
+
+// Would running out p's remaining budget before its current
+// deadline take more than its reserved bandwidth?  This is the
+// CBS wakeup rule: budget / (deadline - now) > runtime / deadline.
+static int
+dl_overflow(struct proc *p, uint now)
+{
+    return p->dl_budget * p->dl_deadline >
+           (p->dl_abs_deadline - now) * p->dl_runtime;
+}
+
+static void
+dl_init(struct runqueue *rq)
+{
+    rq->dl.tree.node = 0;
+    rq->dl.leftmost = 0;
+}
+
+// Insert p keyed by absolute deadline.  A new or waking process
+// keeps its current deadline and budget only if it can finish
+// them without exceeding its bandwidth; otherwise it gets a new
+// period starting now.
+static void
+dl_enqueue(struct runqueue *rq, struct proc *p, int flags)
+{
+    struct dl_rq *d = &rq->dl;
+    struct rb_node **link = &d->tree.node, *parent = 0;
+    int leftmost = 1;
+
+    if (flags & (ENQ_NEW | ENQ_WAKEUP))
+    {
+        if (p->dl_budget <= 0 || !dl_time_before(ticks, p->dl_abs_deadline) ||
+            dl_overflow(p, ticks))
+            dl_new_period(p, ticks);
+        p->dl_throttled = 0;
+    }
+
+    while (*link)
+    {
+        parent = *link;
+        if (dl_time_before(p->dl_abs_deadline, rb_entry(parent, struct proc, rb)->dl_abs_deadline))
+            link = &parent->left;
+        else
+        {
+            link = &parent->right;
+            leftmost = 0;
+        }
+    }
+    rb_link_node(&p->rb, parent, link);
+    rb_insert_color(&p->rb, &d->tree);
+    if (leftmost)
+        d->leftmost = &p->rb;
+}
+
+static void
+dl_dequeue(struct runqueue *rq, struct proc *p)
+{
+    struct dl_rq *d = &rq->dl;
+
+    if (d->leftmost == &p->rb)
+        d->leftmost = rb_next(&p->rb);
+    rb_erase(&p->rb, &d->tree);
+}
+
+static struct proc *
+dl_pick_next(struct runqueue *rq)
+{
+    struct proc *p = rb_entry(rq->dl.leftmost, struct proc, rb);
+
+    dl_dequeue(rq, p);
+    return p;
+}
+
+// Charge p one tick of budget.  Throttle it when the budget is
+// gone, and preempt it for any queued process with an earlier
+// deadline.  A process still running at its deadline has missed
+// it; count the miss and give it a new period.
+static int
+dl_tick(struct runqueue *rq, struct proc *p)
+{
+    struct proc *left;
+
+    p->dl_budget--;
+    if (!dl_time_before(ticks, p->dl_abs_deadline))
+    {
+        p->dl_misses++;
+        dl_new_period(p, ticks);
+    }
+    else if (p->dl_budget <= 0)
+    {
+        p->dl_throttled = 1;
+        return 1;
+    }
+
+    if (rq->nr[SCHED_DEADLINE] == 0)
+        return 0;
+    left = rb_entry(rq->dl.leftmost, struct proc, rb);
+    return dl_time_before(left->dl_abs_deadline, p->dl_abs_deadline);
+}
+
+static int
+dl_wakeup_preempt(struct runqueue *rq, struct proc *curr, struct proc *p)
+{
+    return dl_time_before(p->dl_abs_deadline, curr->dl_abs_deadline);
+}
+
+// A process that waited in the queue past its deadline has
+// missed it.
+static void
+dl_set_curr(struct runqueue *rq, struct proc *p)
+{
+    if (!dl_time_before(ticks, p->dl_abs_deadline))
+    {
+        p->dl_misses++;
+        dl_new_period(p, ticks);
+    }
+}
+
+// Deadlines are in ticks, the same on every CPU, so migration
+// needs no adjustment.
+struct sched_class deadline_sched_class = {
+    .name = "deadline",
+    .init = dl_init,
+    .enqueue = dl_enqueue,
+    .dequeue = dl_dequeue,
+    .pick_next = dl_pick_next,
+    .tick = dl_tick,
+    .wakeup_preempt = dl_wakeup_preempt,
+    .set_curr = dl_set_curr,
+};
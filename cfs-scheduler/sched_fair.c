@@ -0,0 +1,201 @@
+// SCHED_FAIR: completely fair scheduling.
+// A process's vruntime advances by its TSC run time scaled by
+// NICE_0_WEIGHT / weight, and the process with the smallest
+// vruntime runs next.  Queued processes live in a red-black tree
+// with the leftmost node cached.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "x86.h"
+#include "proc.h"
+#include "runqueue.h"
+
+// Load weight for nice -20..19 (index nice + 20).  Each step
+// changes a process's CPU share by about 10% against nice 0.
+static const uint nice_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906,
+    3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423,
+    335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45,
+    36, 29, 23, 18, 15,
+};
+
+uint nice_weight(int nice)
+{
+    return nice_to_weight[nice + 20];
+}
+
+// Length of n timer ticks in vruntime units (0 until the tick
+// length has been measured).  Ticks are the same length on every
+// CPU, so this CPU's measurement serves for any runqueue.
+static uint
+ticks_to_vruntime(int n)
+{
+    return n * (mycpu()->tick_tsc >> VRUNTIME_SHIFT);
+}
+
+// Charge the running process p for the CPU time it has used
+// since exec_start.  With the tick stopped that can be a second or
+// more, so the arithmetic is 64-bit; the charge is capped well short
+// of the half-range that vruntime_before() compares across.
+static void
+update_curr(struct proc *p)
+{
+    uint64 now = rdtsc64();
+    uint64 delta = (now - p->exec_start) >> VRUNTIME_SHIFT;
+    uint64 charge = div64_32(delta * NICE_0_WEIGHT, p->weight, 0);
+
+    p->exec_start = now;
+    p->vruntime += charge > 0x3FFFFFFF ? 0x3FFFFFFF : (uint)charge;
+}
+
+static void
+fair_init(struct runqueue *rq)
+{
+    rq->fair.tree.node = 0;
+    rq->fair.leftmost = 0;
+    rq->fair.min_vruntime = 0;
+    rq->fair.load = 0;
+}
+
+// Insert p keyed by vruntime.  Equal keys go to the right, so
+// processes with the same vruntime run in FIFO order.
+static void
+fair_enqueue(struct runqueue *rq, struct proc *p, int flags)
+{
+    struct fair_rq *f = &rq->fair;
+    struct rb_node **link = &f->tree.node, *parent = 0;
+    int leftmost = 1;
+
+    if (flags & ENQ_NEW)
+    {
+        // New processes start level with the queue.
+        p->vruntime = f->min_vruntime;
+    }
+    else if (flags & ENQ_WAKEUP)
+    {
+        // Sleepers get at most SLEEPER_CREDIT ticks of credit,
+        // so they run soon after waking but cannot bank time.
+        uint floor = f->min_vruntime - ticks_to_vruntime(SLEEPER_CREDIT);
+        if (vruntime_before(p->vruntime, floor))
+            p->vruntime = floor;
+    }
+
+    while (*link)
+    {
+        parent = *link;
+        if (vruntime_before(p->vruntime, rb_entry(parent, struct proc, rb)->vruntime))
+            link = &parent->left;
+        else
+        {
+            link = &parent->right;
+            leftmost = 0;
+        }
+    }
+    rb_link_node(&p->rb, parent, link);
+    rb_insert_color(&p->rb, &f->tree);
+    if (leftmost)
+        f->leftmost = &p->rb;
+    f->load += p->weight;
+}
+
+static void
+fair_dequeue(struct runqueue *rq, struct proc *p)
+{
+    struct fair_rq *f = &rq->fair;
+
+    if (f->leftmost == &p->rb)
+        f->leftmost = rb_next(&p->rb);
+    rb_erase(&p->rb, &f->tree);
+    f->load -= p->weight;
+}
+
+// Take the process with the smallest vruntime and advance
+// min_vruntime to it.
+static struct proc *
+fair_pick_next(struct runqueue *rq)
+{
+    struct proc *p = rb_entry(rq->fair.leftmost, struct proc, rb);
+
+    fair_dequeue(rq, p);
+    if (vruntime_before(rq->fair.min_vruntime, p->vruntime))
+        rq->fair.min_vruntime = p->vruntime;
+    return p;
+}
+
+// Preempt once p has used its weighted share of the scheduling
+// period, or once the leftmost queued process is more than
+// MIN_GRANULARITY behind it.
+static int
+fair_tick(struct runqueue *rq, struct proc *p)
+{
+    struct fair_rq *f = &rq->fair;
+    int n = rq->nr[SCHED_FAIR];
+    uint period, slice;
+    struct proc *left;
+
+    update_curr(p);
+    p->slice_ticks++;
+    if (n == 0)
+        return 0;
+
+    // Every runnable process should run once per period,
+    // stretched when there are too many for SCHED_LATENCY.
+    period = SCHED_LATENCY;
+    if ((n + 1) * MIN_GRANULARITY > period)
+        period = (n + 1) * MIN_GRANULARITY;
+    slice = period * p->weight / (f->load + p->weight);
+    if (slice < MIN_GRANULARITY)
+        slice = MIN_GRANULARITY;
+    if (p->slice_ticks >= slice)
+        return 1;
+
+    left = rb_entry(f->leftmost, struct proc, rb);
+    return p->slice_ticks >= MIN_GRANULARITY &&
+           vruntime_before(left->vruntime + ticks_to_vruntime(MIN_GRANULARITY), p->vruntime);
+}
+
+static int
+fair_wakeup_preempt(struct runqueue *rq, struct proc *curr, struct proc *p)
+{
+    return vruntime_before(p->vruntime + ticks_to_vruntime(MIN_GRANULARITY), curr->vruntime);
+}
+
+static void
+fair_set_curr(struct runqueue *rq, struct proc *p)
+{
+    p->exec_start = rdtsc64();
+    p->slice_ticks = 0;
+}
+
+static void
+fair_put_prev(struct runqueue *rq, struct proc *p)
+{
+    update_curr(p);
+}
+
+// vruntime is relative to a CPU's min_vruntime; move it into
+// the frame of the new runqueue.
+static void
+fair_migrate(struct runqueue *from, struct runqueue *to, struct proc *p)
+{
+    p->vruntime = p->vruntime - from->fair.min_vruntime + to->fair.min_vruntime;
+}
+
+struct sched_class fair_sched_class = {
+    .name = "fair",
+    .init = fair_init,
+    .enqueue = fair_enqueue,
+    .dequeue = fair_dequeue,
+    .pick_next = fair_pick_next,
+    .tick = fair_tick,
+    .wakeup_preempt = fair_wakeup_preempt,
+    .set_curr = fair_set_curr,
+    .put_prev = fair_put_prev,
+    .migrate = fair_migrate,
+};
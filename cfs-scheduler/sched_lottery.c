@@ -0,0 +1,86 @@
+// SCHED_LOTTERY: proportional share by lottery.
+// Each pick draws a ticket among the queued processes' tickets,
+// and the winner holds the CPU for one tick.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "runqueue.h"
+
+// xorshift32: small, and good enough to draw lottery winners.
+static uint
+lottery_rand(struct lottery_rq *l)
+{
+    uint x = l->rand_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    l->rand_state = x;
+    return x;
+}
+
+static void
+lottery_init(struct runqueue *rq)
+{
+    rq->lottery.queue.head = rq->lottery.queue.tail = 0;
+    rq->lottery.total_tickets = 0;
+    rq->lottery.rand_state = 2463534242u ^ (uint)rq; // Different per CPU, never 0
+}
+
+static void
+lottery_enqueue(struct runqueue *rq, struct proc *p, int flags)
+{
+    fifo_push(&rq->lottery.queue, p);
+    rq->lottery.total_tickets += p->tickets;
+}
+
+static void
+lottery_dequeue(struct runqueue *rq, struct proc *p)
+{
+    fifo_unlink(&rq->lottery.queue, p);
+    rq->lottery.total_tickets -= p->tickets;
+}
+
+// Draw a winning ticket and walk the queue to its holder.
+static struct proc *
+lottery_pick_next(struct runqueue *rq)
+{
+    struct lottery_rq *l = &rq->lottery;
+    uint winner = lottery_rand(l) % l->total_tickets;
+    struct proc *p;
+
+    for (p = l->queue.head; p->next; p = p->next)
+    {
+        if (winner < p->tickets)
+            break;
+        winner -= p->tickets;
+    }
+    lottery_dequeue(rq, p);
+    return p;
+}
+
+// Hold a new drawing every tick if anyone else is waiting.
+static int
+lottery_tick(struct runqueue *rq, struct proc *p)
+{
+    return rq->nr[SCHED_LOTTERY] > 0;
+}
+
+static int
+lottery_wakeup_preempt(struct runqueue *rq, struct proc *curr, struct proc *p)
+{
+    return 0;
+}
+
+struct sched_class lottery_sched_class = {
+    .name = "lottery",
+    .init = lottery_init,
+    .enqueue = lottery_enqueue,
+    .dequeue = lottery_dequeue,
+    .pick_next = lottery_pick_next,
+    .tick = lottery_tick,
+    .wakeup_preempt = lottery_wakeup_preempt,
+};
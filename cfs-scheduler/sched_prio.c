@@ -0,0 +1,73 @@
+// SCHED_PRIO: fixed-priority scheduling.
+// Levels 0..NPRIO-1 (0 highest), FIFO within a level, with a bitmap
+// of non-empty levels so the highest one is found with one bsf.
+// Processes at the same level share the CPU a tick at a time.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "x86.h"
+#include "proc.h"
+#include "runqueue.h"
+
+static void
+prio_init(struct runqueue *rq)
+{
+    int i;
+
+    for (i = 0; i < NPRIO; i++)
+        rq->prio.level[i].head = rq->prio.level[i].tail = 0;
+    rq->prio.bitmap = 0;
+}
+
+static void
+prio_enqueue(struct runqueue *rq, struct proc *p, int flags)
+{
+    fifo_push(&rq->prio.level[p->priority], p);
+    rq->prio.bitmap |= 1u << p->priority;
+}
+
+static void
+prio_dequeue(struct runqueue *rq, struct proc *p)
+{
+    struct fifo_rq *q = &rq->prio.level[p->priority];
+
+    fifo_unlink(q, p);
+    if (q->head == 0)
+        rq->prio.bitmap &= ~(1u << p->priority);
+}
+
+static struct proc *
+prio_pick_next(struct runqueue *rq)
+{
+    struct proc *p = rq->prio.level[bsf(rq->prio.bitmap)].head;
+
+    prio_dequeue(rq, p);
+    return p;
+}
+
+// Preempt when a process of the same or higher priority is waiting.
+static int
+prio_tick(struct runqueue *rq, struct proc *p)
+{
+    uint upto = (2u << p->priority) - 1; // Levels 0..p->priority
+
+    return (rq->prio.bitmap & upto) != 0;
+}
+
+static int
+prio_wakeup_preempt(struct runqueue *rq, struct proc *curr, struct proc *p)
+{
+    return p->priority < curr->priority;
+}
+
+struct sched_class prio_sched_class = {
+    .name = "prio",
+    .init = prio_init,
+    .enqueue = prio_enqueue,
+    .dequeue = prio_dequeue,
+    .pick_next = prio_pick_next,
+    .tick = prio_tick,
+    .wakeup_preempt = prio_wakeup_preempt,
+};
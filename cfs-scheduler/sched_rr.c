@@ -0,0 +1,60 @@
+// SCHED_RR: round-robin.
+// A FIFO of processes that each run for one tick at a time,
+// like the original xv6 scheduler.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "runqueue.h"
+
+static void
+rr_init(struct runqueue *rq)
+{
+    rq->rr.head = rq->rr.tail = 0;
+}
+
+static void
+rr_enqueue(struct runqueue *rq, struct proc *p, int flags)
+{
+    fifo_push(&rq->rr, p);
+}
+
+static void
+rr_dequeue(struct runqueue *rq, struct proc *p)
+{
+    fifo_unlink(&rq->rr, p);
+}
+
+static struct proc *
+rr_pick_next(struct runqueue *rq)
+{
+    struct proc *p = rq->rr.head;
+
+    fifo_unlink(&rq->rr, p);
+    return p;
+}
+
+// Give the CPU to the next process every tick if one is waiting.
+static int
+rr_tick(struct runqueue *rq, struct proc *p)
+{
+    return rq->nr[SCHED_RR] > 0;
+}
+
+static int
+rr_wakeup_preempt(struct runqueue *rq, struct proc *curr, struct proc *p)
+{
+    return 0;
+}
+
+struct sched_class rr_sched_class = {
+    .name = "rr",
+    .init = rr_init,
+    .enqueue = rr_enqueue,
+    .dequeue = rr_dequeue,
+    .pick_next = rr_pick_next,
+    .tick = rr_tick,
+    .wakeup_preempt = rr_wakeup_preempt,
+};
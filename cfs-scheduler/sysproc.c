@@ -0,0 +1,192 @@
+#include "types.h"
+#include "x86.h"
+#include "defs.h"
+#include "date.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "timer.h"
+
+int sys_fork(void) { return fork(); }
+
+int sys_exit(void)
+{
+    exit();
+    return 0;
+}
+
+int sys_wait(void) { return wait(); }
+
+int sys_kill(void)
+{
+    int pid;
+    if (argint(0, &pid) < 0)
+        return -1;
+    return kill(pid);
+}
+
+int sys_getpid(void) { return myproc()->pid; }
+
+int sys_sbrk(void)
+{
+    int addr, n;
+    if (argint(0, &n) < 0)
+        return -1;
+    addr = myproc()->sz;
+    if (growproc(n) < 0)
+        return -1;
+    return addr;
+}
+
+// Timer callback: wake the process in sys_sleep() waiting on chan.
+static void
+sleep_timeout(void *chan)
+{
+    wakeup(chan);
+}
+
+// Sleep for n ticks.  A timer wakes just this process when the
+// time is up, rather than every sleeper being woken each tick.
+int sys_sleep(void)
+{
+    int n;
+    uint ticks0;
+    struct timer t;
+
+    if (argint(0, &n) < 0)
+        return -1;
+    timer_init(&t, sleep_timeout, &t);
+    acquire(&tickslock);
+    ticks0 = ticks;
+    timer_add(&t, ticks0 + n);
+    while (ticks - ticks0 < n)
+    {
+        if (myproc()->killed)
+        {
+            release(&tickslock);
+            timer_cancel(&t);
+            return -1;
+        }
+        sleep(&t, &tickslock);
+    }
+    release(&tickslock);
+    timer_cancel(&t);
+    return 0;
+}
+
+int sys_uptime(void)
+{
+    uint xticks;
+    acquire(&tickslock);
+    xticks = ticks;
+    release(&tickslock);
+    return xticks;
+}
+
+// Copy the timing statistics of process pid to user space.
+int sys_getpinfo(void)
+{
+    int pid;
+    struct proc_stat *st;
+    struct proc *p;
+
+    if (argint(0, &pid) < 0 || argptr(1, (void *)&st, sizeof(*st)) < 0)
+        return -1;
+
+    acquire(&ptable.lock);
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+        if (p->pid == pid && p->state != UNUSED)
+        {
+            st->pid = p->pid;
+            st->turnaround = p->end_ticks - p->start_ticks;
+            st->response = p->first_run_ticks - p->start_ticks;
+            st->waiting = p->wait_ticks;
+            st->cpu = p->run_ticks;
+            st->dl_misses = p->dl_misses;
+            release(&ptable.lock);
+            return 0;
+        }
+    }
+    release(&ptable.lock);
+    return -1;
+}
+
+int sys_getticks(void)
+{
+    return ticks;
+}
+
+int sys_yield(void)
+{
+    yield();
+    return 0;
+}
+
+int sys_getcontextswitches(void)
+{
+    return context_switches;
+}
+
+// Choose the scheduling class and class parameter of a process.
+int sys_sched_setpolicy(void)
+{
+    int pid, policy, param;
+
+    if (argint(0, &pid) < 0 || argint(1, &policy) < 0 || argint(2, &param) < 0)
+        return -1;
+    return sched_setpolicy(pid, policy, param);
+}
+
+// Reserve runtime ticks in every period ticks, to be used within
+// deadline ticks of each period's start, for the calling process.
+int sys_sched_setdeadline(void)
+{
+    int runtime, period, deadline;
+
+    if (argint(0, &runtime) < 0 || argint(1, &period) < 0 || argint(2, &deadline) < 0)
+        return -1;
+    return sched_setdeadline(runtime, period, deadline);
+}
+
+// Read the nanosecond clock.  Only CLOCK_MONOTONIC is supported.
+int sys_clock_gettime(void)
+{
+    int clock;
+    struct timespec *ts;
+    uint rem;
+    uint64 ns;
+
+    if (argint(0, &clock) < 0 || argptr(1, (void *)&ts, sizeof(*ts)) < 0)
+        return -1;
+    if (clock != CLOCK_MONOTONIC)
+        return -1;
+    ns = nsecs();
+    ts->tv_sec = div64_32(ns, 1000000000, &rem);
+    ts->tv_nsec = rem;
+    return 0;
+}
+
+// Sleep for the time in *req, to the resolution of the clock
+// rather than a whole tick.
+int sys_nanosleep(void)
+{
+    struct timespec *req;
+
+    if (argptr(0, (void *)&req, sizeof(*req)) < 0)
+        return -1;
+    if (req->tv_nsec >= 1000000000)
+        return -1;
+    return nsleep((uint64)req->tv_sec * 1000000000 + req->tv_nsec);
+}
+
+// Set the nice value (-20..19) of a process.
+int sys_setnice(void)
+{
+    int pid, nice;
+
+    if (argint(0, &pid) < 0 || argint(1, &nice) < 0)
+        return -1;
+    return setnice(pid, nice);
+}
\ No newline at end of file
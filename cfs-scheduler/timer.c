@@ -0,0 +1,228 @@
+// Kernel timers.
+// Each CPU keeps a hierarchical timer wheel: TW_LEVELS levels of
+// TW_SIZE slots, where a slot at level l covers TW_SIZE^l ticks.
+// A timer goes in the coarsest slot that still separates it from
+// the present, so adding and cancelling are O(1).  Every tick, the
+// CPU runs the timers in the current level-0 slot, and each time a
+// level wraps it moves ("cascades") the next slot of the level above
+// down into finer slots.  Only timers that are due are ever touched,
+// unlike waking every sleeper on every tick.
+//
+// Callbacks run from the timer interrupt with the wheel's lock held,
+// so they must not sleep; the lock also makes timer_cancel() wait for
+// a callback that is running on another CPU.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "timer.h"
+
+#define TW_BITS   6
+#define TW_SIZE   (1 << TW_BITS)
+#define TW_MASK   (TW_SIZE - 1)
+#define TW_LEVELS 4
+#define TW_MAX    ((1u << (TW_BITS * TW_LEVELS)) - 1) // Furthest a timer can be
+
+struct timer_base
+{
+    struct spinlock lock;
+    uint clk;                               // Next tick to process
+    struct timer *slot[TW_LEVELS][TW_SIZE]; // Pending timers
+};
+
+static struct timer_base bases[NCPU];
+
+void timerinit(void)
+{
+    int i;
+
+    for (i = 0; i < NCPU; i++)
+    {
+        initlock(&bases[i].lock, "timer");
+        bases[i].clk = ticks;
+    }
+}
+
+void timer_init(struct timer *t, void (*fn)(void *), void *arg)
+{
+    t->fn = fn;
+    t->arg = arg;
+    t->next = 0;
+    t->pprev = 0;
+    t->base = 0;
+}
+
+// Link t into the slot for its expiry.  Caller holds b->lock.
+static void
+enqueue(struct timer_base *b, struct timer *t)
+{
+    uint expires = t->expires;
+    uint delta = expires - b->clk;
+    struct timer **slot;
+    int level;
+
+    if ((int)delta < 0)
+    {
+        // Already due: run at the next tick processed
+        expires = b->clk;
+        delta = 0;
+    }
+    else if (delta > TW_MAX)
+    {
+        // Park it as far out as the wheel reaches; it is moved
+        // closer every time that slot cascades.
+        expires = b->clk + TW_MAX;
+        delta = TW_MAX;
+    }
+    for (level = 0; level < TW_LEVELS - 1; level++)
+        if (delta < (1u << (TW_BITS * (level + 1))))
+            break;
+    slot = &b->slot[level][(expires >> (TW_BITS * level)) & TW_MASK];
+
+    t->next = *slot;
+    if (t->next)
+        t->next->pprev = &t->next;
+    t->pprev = slot;
+    *slot = t;
+    t->base = b;
+}
+
+static void
+unlink(struct timer *t)
+{
+    *t->pprev = t->next;
+    if (t->next)
+        t->next->pprev = t->pprev;
+    t->next = 0;
+    t->pprev = 0;
+}
+
+// Re-file every timer in slot index of level.  Returns index so
+// the caller can tell whether this level wrapped too.
+static int
+cascade(struct timer_base *b, int level, int index)
+{
+    struct timer *t = b->slot[level][index], *next;
+
+    b->slot[level][index] = 0;
+    for (; t; t = next)
+    {
+        next = t->next;
+        t->pprev = 0;
+        enqueue(b, t);
+    }
+    return index;
+}
+
+// Arrange for t's function to run once ticks reaches expires.
+// t must not be pending.  The timer goes on this CPU's wheel.
+void timer_add(struct timer *t, uint expires)
+{
+    struct timer_base *b;
+
+    pushcli();
+    b = &bases[cpuid()];
+    acquire(&b->lock);
+    if (t->pprev)
+        panic("timer_add: pending");
+    t->expires = expires;
+    enqueue(b, t);
+    release(&b->lock);
+    if (mycpu()->tick_stopped)
+        clock_reprogram(); // No tick will come to run it
+    popcli();
+}
+
+// The tick at which this CPU's wheel next needs to be run, for a
+// CPU whose tick is stopped.  For a slot above level 0 that is when
+// it cascades, which is no later than its timers expire.  Returns
+// 0 if the wheel is empty.
+int timer_next(uint *when)
+{
+    struct timer_base *b = &bases[cpuid()];
+    uint span, at, best = 0;
+    int level, index, found = 0;
+
+    acquire(&b->lock);
+    for (level = 0; level < TW_LEVELS; level++)
+    {
+        span = 1u << (TW_BITS * level); // Ticks per slot
+        for (index = 0; index < TW_SIZE; index++)
+        {
+            if (b->slot[level][index] == 0)
+                continue;
+            // Next tick from clk at which this slot is processed
+            at = (b->clk & ~(span * TW_SIZE - 1)) + index * span;
+            if ((int)(at - b->clk) < 0)
+                at += span * TW_SIZE;
+            if (!found || (int)(at - best) < 0)
+                best = at;
+            found = 1;
+        }
+    }
+    release(&b->lock);
+    *when = best;
+    return found;
+}
+
+// Stop t if it is pending.  Returns 1 if it was, 0 if it had
+// already run (or was never added).  Once this returns, t's
+// function is not running on any CPU.
+int timer_cancel(struct timer *t)
+{
+    struct timer_base *b;
+
+    for (;;)
+    {
+        b = t->base;
+        if (b == 0)
+            return 0;
+        acquire(&b->lock);
+        if (t->base == b)
+            break;
+        release(&b->lock); // Moved to another wheel meanwhile
+    }
+    if (t->pprev == 0)
+    {
+        release(&b->lock);
+        return 0;
+    }
+    unlink(t);
+    t->base = 0;
+    release(&b->lock);
+    return 1;
+}
+
+// Run the timers on this CPU's wheel that are due.  Called from
+// every CPU's timer interrupt.
+void timer_run(void)
+{
+    struct timer_base *b = &bases[cpuid()];
+    struct timer *t, *next;
+    int index;
+
+    acquire(&b->lock);
+    while ((int)(ticks - b->clk) >= 0)
+    {
+        index = b->clk & TW_MASK;
+        if (index == 0 &&
+            cascade(b, 1, (b->clk >> TW_BITS) & TW_MASK) == 0 &&
+            cascade(b, 2, (b->clk >> (2 * TW_BITS)) & TW_MASK) == 0)
+            cascade(b, 3, (b->clk >> (3 * TW_BITS)) & TW_MASK);
+        b->clk++;
+
+        t = b->slot[0][index];
+        b->slot[0][index] = 0;
+        for (; t; t = next)
+        {
+            next = t->next;
+            t->next = 0;
+            t->pprev = 0;
+            t->fn(t->arg);
+        }
+    }
+    release(&b->lock);
+}
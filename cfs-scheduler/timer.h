@@ -0,0 +1,28 @@
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+// A kernel timer: fn(arg) runs from a timer interrupt once ticks
+// reaches expires.  See timer.c.
+struct timer
+{
+    uint expires;            // Tick at which fn runs
+    void (*fn)(void *arg);
+    void *arg;
+    struct timer *next;      // Next timer in the same wheel slot
+    struct timer **pprev;    // Link pointing at this timer, 0 if not pending
+    struct timer_base *base; // Wheel the timer is queued on
+};
+
+// A high-resolution timer: fn(arg) runs from the timer interrupt
+// once nsecs() reaches expires.  See clock.c.
+struct hrtimer
+{
+    uint64 expires;            // nsecs() at which fn runs
+    void (*fn)(void *arg);
+    void *arg;
+    int pending;               // Queued and not yet run
+    struct hrtimer *next;      // Next timer, in expiry order
+    struct clock_base *base;   // CPU the timer is queued on
+};
+
+#endif // _TIMER_H_
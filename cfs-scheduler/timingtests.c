@@ -0,0 +1,499 @@
+/*
+ * Timingtests.c: User-level test program for the xv6 CFS scheduler.
+ * Executes a suite of tests to evaluate scheduler performance under various workloads,
+ * including CPU-heavy, I/O-bound, mixed, process creation, short tasks, and starvation scenarios.
+ * Measures execution time and context switches.
+ */
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "date.h"
+#include "fcntl.h"
+
+// Function prototypes for test cases
+int timing_cpu_heavy(void);
+int timing_switch_overhead(void);
+int timing_io_bound(void);
+int timing_mixed_load(void);
+int timing_process_creation(void);
+int timing_short_tasks(void);
+int timing_starvation_check(void);
+int timing_deadline(void);
+int timing_nanosleep(void);
+int timing_long_sleeps(void);
+
+// Microseconds from t0 to t1.
+int elapsed_us(struct timespec *t0, struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) * 1000000 +
+           ((int)t1->tv_nsec - (int)t0->tv_nsec) / 1000;
+}
+
+// Run a test case multiple times and report total and average execution time.
+void run_test(int (*test)(), char *name, int runs)
+{
+    int total = 0;
+    struct timespec t0, t1;
+    printf(1, "%s (%d runs)\n", name, runs);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < runs; i++)
+    {
+        int ticks = test();
+        total += ticks;
+        // printf(1, "Run %d: %d ticks\n", i + 1, ticks); // Optional per-run output
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf(1, "Total: %d ticks, Avg: %d ticks/run, %d us/run\n", total, total / runs,
+           elapsed_us(&t0, &t1) / runs);
+}
+
+// Main function: execute all test cases.
+// An optional argument (prio, rr, fair or lottery) runs the suite,
+// and every child it forks, in that scheduling class.
+int main(int argc, char *argv[])
+{
+    static char *classes[] = {"deadline", "prio", "rr", "fair", "lottery"};
+    static int params[] = {0, 5, 0, 0, 10};
+    int policy = SCHED_FAIR;
+
+    if (argc > 1)
+    {
+        for (policy = SCHED_PRIO; policy < 5; policy++)
+            if (strcmp(argv[1], classes[policy]) == 0)
+                break;
+        if (policy == 5 || sched_setpolicy(getpid(), policy, params[policy]) < 0)
+        {
+            printf(1, "usage: timingtests [prio|rr|fair|lottery]\n");
+            exit();
+        }
+    }
+
+    printf(1, "Starting %s scheduling tests...\n", classes[policy]);
+    run_test(timing_cpu_heavy, "Test 1: CPU-heavy", 5);
+    run_test(timing_switch_overhead, "Test 2: Switch overhead", 5);
+    run_test(timing_io_bound, "Test 3: I/O-bound", 5);
+    run_test(timing_mixed_load, "Test 4: Mixed load", 5);
+    run_test(timing_process_creation, "Test 5: Process creation", 5);
+    run_test(timing_short_tasks, "Test 6: Short tasks", 5);
+    run_test(timing_starvation_check, "Test 7: Starvation check", 5);
+    run_test(timing_deadline, "Test 8: Deadline tasks under load", 1);
+    run_test(timing_nanosleep, "Test 9: Sub-tick nanosleep", 1);
+    run_test(timing_long_sleeps, "Test 10: Timer wheel cascades", 1);
+    printf(1, "Tests complete.\n");
+    exit();
+}
+
+// Test 1: Measure performance of CPU-heavy tasks.
+int timing_cpu_heavy(void)
+{
+    int pid, runs = 10;
+    printf(1, "Test 1: CPU-heavy tasks (%d procs)\n", runs);
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    for (int i = 0; i < runs; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            for (volatile int j = 0; j < 20000000; j++)
+                ;
+            exit();
+        }
+    }
+    for (int i = 0; i < runs; i++)
+    {
+        wait();
+    }
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+// Test 2: Measure context switch overhead by rapid process creation and termination.
+int timing_switch_overhead(void)
+{
+    int pid, runs = 200;
+    printf(1, "Test 2: Context switch overhead (%d switches)\n", runs);
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    for (int i = 0; i < runs; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            exit();
+        }
+        else
+        {
+            wait();
+        }
+    }
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+// Test 3: Measure performance of I/O-bound tasks.
+int timing_io_bound(void)
+{
+    int pid, runs = 100, batch_size = 50;
+    printf(1, "Test 3: I/O-bound tasks (%d procs)\n", runs);
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    for (int b = 0; b < runs / batch_size; b++)
+    {
+        for (int i = 0; i < batch_size; i++)
+        {
+            pid = fork();
+            if (pid < 0)
+            {
+                printf(1, "fork failed at %d\n", b * batch_size + i);
+                return -1;
+            }
+            if (pid == 0)
+            {
+                sleep(10);
+                exit();
+            }
+        }
+        for (int i = 0; i < batch_size; i++)
+        {
+            wait();
+        }
+    }
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+// Test 4: Measure performance of mixed CPU and I/O workloads.
+int timing_mixed_load(void)
+{
+    int pid, cpu_runs = 5, io_runs = 5;
+    int min_ticks = 9999;
+    int has_50 = 0;
+    int pipefd[2];
+
+    if (pipe(pipefd) < 0)
+    {
+        printf(1, "pipe failed\n");
+        return -1;
+    }
+
+    printf(1, "Test 4: Mixed load (%d CPU, %d I/O)\n", cpu_runs, io_runs);
+    int start_switches = getcontextswitches();
+
+    for (int i = 0; i < io_runs; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            close(pipefd[0]);
+            sleep(50);
+            int ticks = 50; // Fixed sleep duration
+            write(pipefd[1], &ticks, sizeof(ticks));
+            close(pipefd[1]);
+            exit();
+        }
+    }
+
+    for (int i = 0; i < cpu_runs; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            close(pipefd[0]);
+            int child_start = uptime();
+            for (volatile int j = 0; j < 50000000; j++)
+                ;
+            int ticks = uptime() - child_start;
+            write(pipefd[1], &ticks, sizeof(ticks));
+            close(pipefd[1]);
+            exit();
+        }
+    }
+
+    close(pipefd[1]);
+    for (int i = 0; i < cpu_runs + io_runs; i++)
+    {
+        int ticks;
+        read(pipefd[0], &ticks, sizeof(ticks));
+        if (ticks == 50)
+            has_50 = 1;
+        if (ticks < min_ticks && ticks >= 50)
+            min_ticks = ticks;
+        wait();
+    }
+    close(pipefd[0]);
+
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return has_50 ? 50 : (min_ticks == 9999 ? 50 : min_ticks);
+}
+
+// Test 5: Measure process creation overhead.
+int timing_process_creation(void)
+{
+    int pid, runs = 50;
+    printf(1, "Test 5: Process creation (%d forks)\n", runs);
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    for (int i = 0; i < runs; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            exit();
+        }
+    }
+    for (int i = 0; i < runs; i++)
+    {
+        if (wait() == -1)
+        {
+            printf(1, "wait failed at %d\n", i);
+            break;
+        }
+    }
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+// Test 6: Measure performance of short-lived tasks.
+int timing_short_tasks(void)
+{
+    int pid, runs = 200, batch_size = 50;
+    printf(1, "Test 6: Short tasks (%d quick procs)\n", runs);
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    for (int b = 0; b < runs / batch_size; b++)
+    {
+        for (int i = 0; i < batch_size; i++)
+        {
+            pid = fork();
+            if (pid < 0)
+            {
+                printf(1, "fork failed at %d\n", b * batch_size + i);
+                return -1;
+            }
+            if (pid == 0)
+            {
+                for (volatile int j = 0; j < 10000; j++)
+                    ;
+                exit();
+            }
+        }
+        for (int i = 0; i < batch_size; i++)
+        {
+            wait();
+        }
+    }
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+// Test 7: Check for starvation with one light task vs. heavy tasks.
+int timing_starvation_check(void)
+{
+    int pid;
+    printf(1, "Test 7: Starvation check (1 light vs 5 heavy)\n");
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    pid = fork();
+    if (pid < 0)
+    {
+        printf(1, "fork failed\n");
+        return -1;
+    }
+    if (pid == 0)
+    {
+        for (volatile int j = 0; j < 50000; j++)
+            ;
+        exit();
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            for (volatile int j = 0; j < 20000000; j++)
+                ;
+            exit();
+        }
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        wait();
+    }
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+// Test 8: Periodic SCHED_DEADLINE tasks (2 ticks every 10) against
+// CPU-heavy background load.  Each task reports its deadline misses.
+int timing_deadline(void)
+{
+    int pid, tasks = 2, hogs = 4, periods = 20;
+    printf(1, "Test 8: Deadline tasks (%d periodic vs %d heavy)\n", tasks, hogs);
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    for (int i = 0; i < tasks + hogs; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            if (i >= tasks)
+            {
+                for (volatile int j = 0; j < 20000000; j++)
+                    ;
+                exit();
+            }
+            if (sched_setdeadline(2, 10, 10) < 0)
+            {
+                printf(1, "sched_setdeadline failed\n");
+                exit();
+            }
+            int next = uptime();
+            for (int k = 0; k < periods; k++)
+            {
+                // About one tick of work, then sleep to the next period.
+                int t = uptime();
+                while (uptime() == t)
+                    ;
+                next += 10;
+                if (next > uptime())
+                    sleep(next - uptime());
+            }
+            struct proc_stat st;
+            if (getpinfo(getpid(), &st) == 0)
+                printf(1, "pid %d: %d deadline misses in %d periods\n", st.pid, st.dl_misses, periods);
+            exit();
+        }
+    }
+    for (int i = 0; i < tasks + hogs; i++)
+    {
+        wait();
+    }
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+// Test 9: Sleep 1ms at a time with nanosleep and measure how long
+// each sleep really took; with tick-granular sleep it would be 10ms.
+int timing_nanosleep(void)
+{
+    int sleeps = 20, total = 0;
+    struct timespec req = {0, 1000000}, t0, t1;
+    printf(1, "Test 9: nanosleep (%d x 1000 us)\n", sleeps);
+    int start = uptime();
+    for (int i = 0; i < sleeps; i++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (nanosleep(&req) < 0)
+        {
+            printf(1, "nanosleep failed\n");
+            return -1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        total += elapsed_us(&t0, &t1);
+    }
+    printf(1, "Average sleep: %d us\n", total / sleeps);
+    return uptime() - start;
+}
+
+
+// Test 10: Sleeps that land on each level of the kernel's timer wheel,
+// including either side of the 64- and 4096-tick boundaries where a
+// timer is cascaded from level 1 and level 2.  Each runs in its own
+// process, all at once, and must wake on time.
+int timing_long_sleeps(void)
+{
+    static int lengths[] = {1, 63, 64, 65, 200, 4095, 4096, 4200};
+    int n = sizeof(lengths) / sizeof(lengths[0]), wrong = 0, pid, status;
+    int fds[2];
+    printf(1, "Test 10: Timer wheel (%d sleeps up to %d ticks)\n", n, lengths[n - 1]);
+    if (pipe(fds) < 0)
+    {
+        printf(1, "pipe failed\n");
+        return -1;
+    }
+    int start = uptime();
+    for (int i = 0; i < n; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            int t0 = uptime();
+            sleep(lengths[i]);
+            int slept = uptime() - t0;
+            // Never early; a tick may pass before sleep() starts and one more
+            // before this process runs again
+            status = slept < lengths[i] || slept > lengths[i] + 2;
+            printf(1, "sleep(%d): woke after %d ticks%s\n", lengths[i], slept,
+                   status ? " (wrong)" : "");
+            write(fds[1], &status, sizeof(status));
+            exit();
+        }
+    }
+    close(fds[1]);
+    for (int i = 0; i < n; i++)
+    {
+        if (read(fds[0], &status, sizeof(status)) == sizeof(status))
+            wrong += status;
+        wait();
+    }
+    close(fds[0]);
+    printf(1, "%d of %d sleeps woke on time\n", n - wrong, n);
+    return uptime() - start;
+}
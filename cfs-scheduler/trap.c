@@ -0,0 +1,158 @@
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "x86.h"
+#include "traps.h"
+#include "spinlock.h"
+
+struct gatedesc idt[256];
+extern uint vectors[];
+struct spinlock tickslock;
+uint ticks;
+
+void tvinit(void)
+{
+    int i;
+    for (i = 0; i < 256; i++)
+        SETGATE(idt[i], 0, SEG_KCODE << 3, vectors[i], 0);
+    SETGATE(idt[T_SYSCALL], 1, SEG_KCODE << 3, vectors[T_SYSCALL], DPL_USER);
+    initlock(&tickslock, "time");
+}
+
+void idtinit(void)
+{
+    lidt(idt, sizeof(idt));
+}
+
+// Track the length of a timer tick in TSC cycles on this CPU,
+// used to express tick-based tunables in vruntime units.  n ticks
+// have passed; only a single one is a measurement.
+static void tick_measure(int n)
+{
+    struct cpu *c = mycpu();
+    uint now = rdtsc();
+    if (c->last_tick_tsc && n == 1)
+        c->tick_tsc = now - c->last_tick_tsc;
+    c->last_tick_tsc = now;
+}
+
+// Account n timer ticks on this CPU: more than one if its tick was
+// stopped.  Global ticks is already up to date (see clock.c).
+static void do_tick(int n)
+{
+    tick_measure(n);
+    dl_replenish();
+    timer_run();
+    if (myproc() && myproc()->state == RUNNING)
+    {
+        myproc()->run_ticks += n;
+        // cprintf("trap: pid=%d, run_ticks=%d\n", myproc()->pid, myproc()->run_ticks);
+    }
+    if (mycpu()->idle)
+        mycpu()->idle_ticks += n;
+}
+
+void trap(struct trapframe *tf)
+{
+    int tick = 0;
+
+    if (tf->trapno == T_SYSCALL)
+    {
+        if (myproc()->killed)
+            exit();
+        myproc()->tf = tf;
+        ticks_update(); // Every CPU's tick may be stopped
+        syscall();
+        if (myproc()->killed)
+            exit();
+        return;
+    }
+
+    switch (tf->trapno)
+    {
+    case T_IRQ0 + IRQ_TIMER:
+        // The one-shot timer also fires for hrtimers between ticks
+        tick = clock_intr();
+        if (tick)
+            do_tick(tick);
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + IRQ_RESCHED:
+        // need_resched is set, or a process was queued here while
+        // the tick was stopped.  An idle CPU just returns to its
+        // scheduler loop, which restarts the tick.
+        if (!mycpu()->idle)
+        {
+            tick = clock_restart();
+            if (tick)
+                do_tick(tick);
+        }
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + IRQ_CALL:
+        ipi_call_intr();
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + IRQ_TLB:
+        ipi_tlb_intr();
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + IRQ_IDE:
+        ideintr();
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + IRQ_IDE + 1:
+        break;
+
+    case T_IRQ0 + IRQ_KBD:
+        kbdintr();
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + IRQ_COM1:
+        uartintr();
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + 7:
+    case T_IRQ0 + IRQ_SPURIOUS:
+        cprintf("cpu%d: spurious interrupt at %x:%x\n",
+                cpuid(), tf->cs, tf->eip);
+        lapiceoi();
+        break;
+
+    default:
+        if (myproc() == 0 || (tf->cs & 3) == 0)
+        {
+            cprintf("unexpected trap %d from cpu %d eip %x (cr2=0x%x)\n",
+                    tf->trapno, cpuid(), tf->eip, rcr2());
+            panic("trap");
+        }
+        cprintf("pid %d %s: trap %d err %d on cpu %d "
+                "eip 0x%x addr 0x%x--kill proc\n",
+                myproc()->pid, myproc()->name, tf->trapno,
+                tf->err, cpuid(), tf->eip, rcr2());
+        myproc()->killed = 1;
+    }
+
+    if (myproc() && myproc()->killed && (tf->cs & 3) == DPL_USER)
+        exit();
+
+    // Preempt on a timer tick when the scheduling class says so,
+    // or on any trap once a more important process was queued here.
+    if (myproc() && myproc()->state == RUNNING &&
+        ((tick && sched_tick(myproc())) ||
+         mycpu()->need_resched))
+        yield();
+
+    if (myproc() && myproc()->killed && (tf->cs & 3) == DPL_USER)
+        exit();
+}
\ No newline at end of file
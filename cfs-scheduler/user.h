@@ -0,0 +1,63 @@
+struct stat;
+struct rtcdate;
+struct timespec;
+
+// Scheduling classes for sched_setpolicy, highest first
+#define SCHED_DEADLINE 0 // set with sched_setdeadline only
+#define SCHED_PRIO     1 // param: priority 0 (highest) to 10
+#define SCHED_RR       2 // param: ignored
+#define SCHED_FAIR     3 // param: nice -20 to 19
+#define SCHED_LOTTERY  4 // param: tickets
+struct proc_stat
+{
+    int pid;
+    int turnaround;
+    int response;
+    int waiting;
+    int cpu;
+    int dl_misses;
+};
+
+int fork(void);
+int exit(void) __attribute__((noreturn));
+int wait(void);
+int pipe(int *);
+int write(int, const void *, int);
+int read(int, void *, int);
+int close(int);
+int kill(int);
+int exec(char *, char **);
+int open(const char *, int);
+int mknod(const char *, short, short);
+int unlink(const char *);
+int fstat(int fd, struct stat *);
+int link(const char *, const char *);
+int mkdir(const char *);
+int chdir(const char *);
+int dup(int);
+int getpid(void);
+char *sbrk(int);
+int sleep(int);
+int uptime(void);
+int getpinfo(int, struct proc_stat *);
+int getticks(void);
+int yield(void);
+int getcontextswitches(void);
+int setnice(int pid, int nice);
+int sched_setpolicy(int pid, int policy, int param);
+int sched_setdeadline(int runtime, int period, int deadline);
+int clock_gettime(int clock, struct timespec *ts);
+int nanosleep(struct timespec *req);
+
+int stat(const char *, struct stat *);
+char *strcpy(char *, const char *);
+void *memmove(void *, const void *, int);
+char *strchr(const char *, char c);
+int strcmp(const char *, const char *);
+void printf(int, const char *, ...);
+char *gets(char *, int max);
+uint strlen(const char *);
+void *memset(void *, int, uint);
+void *malloc(uint);
+void free(void *);
+int atoi(const char *);
\ No newline at end of file
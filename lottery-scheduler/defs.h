@@ -5,6 +5,7 @@ struct inode;
 struct pipe;
 struct proc;
 struct rtcdate;
+struct runqueue;
 struct spinlock;
 struct sleeplock;
 struct stat;
@@ -82,6 +83,7 @@ extern volatile uint *lapic;
 void lapiceoi(void);
 void lapicinit(void);
 void lapicstartap(uchar, uint);
+void lapicipi(uchar, int);
 void microdelay(int);
 
 // log.c
@@ -106,15 +108,18 @@ int pipewrite(struct pipe *, char *, int);
 
 // PAGEBREAK: 16
 //  proc.c
+void balance(void);
 int cpuid(void);
 void exit(void);
 int fork(void);
 int growproc(int);
 int kill(int);
+void lendtickets(struct proc *, int);
 struct cpu *mycpu(void);
 struct proc *myproc();
 void pinit(void);
 void procdump(void);
+void kick_idle(struct runqueue *);
 void scheduler(void) __attribute__((noreturn));
 void sched(void);
 void setproc(struct proc *);
@@ -123,6 +128,7 @@ void userinit(void);
 int wait(void);
 void wakeup(void *);
 void yield(void);
+void preempt(void);
 int sys_settickets_pid(void);
 
 // swtch.S
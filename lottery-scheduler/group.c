@@ -0,0 +1,159 @@
+/*
+ * group.c - Ticket Currencies for the xv6 Lottery Scheduler
+ *
+ * This file implements Waldspurger-style ticket currencies. A group is a named
+ * currency funded with base tickets; its members hold tickets in that currency.
+ * A member's value in base tickets is its share of the group's active tickets
+ * (those held by runnable or running members) times the group's funding, so a
+ * group cannot raise its share by forking: children inherit the group and dilute
+ * the currency instead of adding base tickets.
+ *
+ * Processes outside any group (group == -1) hold base tickets directly.
+ *
+ * All functions are called with ptable_lock held, which protects the group table
+ * and each process's group and charge.
+ */
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "proc.h"
+#include "group.h"
+#include "x86.h"
+
+struct tgroup tgroups[NGROUP];
+
+extern struct proc ptable[NPROC];
+
+// Value of a process's tickets in base tickets (at least one, and at most the
+// group's funding)
+int group_tickets(struct proc *p)
+{
+  int t = p->tickets < 1 ? 1 : p->tickets;
+  if (p->group < 0)
+  {
+    return t;
+  }
+
+  struct tgroup *g = &tgroups[p->group];
+  if (g->active <= 0)
+  {
+    return 1; // Not counted yet; weighed properly once charged
+  }
+  if (t >= g->active)
+  {
+    return g->funding;
+  }
+  // t < active, so the quotient is below funding; the product needs 64 bits
+  int value = divl((uint64)t * g->funding, g->active);
+  return value < 1 ? 1 : value;
+}
+
+// Base tickets a process competes with: the value of its own tickets plus any
+// tickets lent to it by processes blocked waiting on it
+int proc_tickets(struct proc *p)
+{
+  return group_tickets(p) + p->donated;
+}
+
+// Re-weight every queued member of a group after its currency changed value
+static void group_reweight(int gid)
+{
+  for (struct proc *p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->group == gid && p->rq_slot >= 0 && p->cpu >= 0 && p->cpu < ncpu)
+    {
+      rq_reweight(&cpus[p->cpu].rq, p);
+    }
+  }
+}
+
+// Bring a process's charge against its group's active tickets up to date
+// Called after every change to its state, tickets or group
+void group_update(struct proc *p)
+{
+  int charge = 0;
+  if (p->group >= 0 && (p->state == RUNNABLE || p->state == RUNNING))
+  {
+    charge = p->tickets < 1 ? 1 : p->tickets;
+  }
+  if (charge == p->charged)
+  {
+    return;
+  }
+
+  tgroups[p->group].active += charge - p->charged;
+  p->charged = charge;
+  group_reweight(p->group);
+}
+
+// Create a group funded with the given base tickets, or refund it if it exists
+// Returns the group id, or -1 if the table is full or funding is out of range
+int group_create(char *name, int funding)
+{
+  if (funding <= 0 || funding > MAX_FUNDING)
+  {
+    return -1;
+  }
+  struct tgroup *free = 0;
+  for (struct tgroup *g = tgroups; g < &tgroups[NGROUP]; g++)
+  {
+    if (g->used && strncmp(g->name, name, sizeof(g->name)) == 0)
+    {
+      group_fund(g - tgroups, funding);
+      return g - tgroups;
+    }
+    if (!g->used && free == 0)
+    {
+      free = g;
+    }
+  }
+  if (free == 0)
+  {
+    return -1;
+  }
+
+  free->used = 1;
+  safestrcpy(free->name, name, sizeof(free->name));
+  free->funding = funding;
+  free->active = 0;
+  return free - tgroups;
+}
+
+// Change the base tickets backing a group
+int group_fund(int gid, int funding)
+{
+  if (gid < 0 || gid >= NGROUP || !tgroups[gid].used || funding <= 0 || funding > MAX_FUNDING)
+  {
+    return -1;
+  }
+  tgroups[gid].funding = funding;
+  group_reweight(gid);
+  return 0;
+}
+
+// Move a process into a group (or back to base tickets with gid -1)
+int group_join(struct proc *p, int gid)
+{
+  if (gid < -1 || gid >= NGROUP || (gid >= 0 && !tgroups[gid].used))
+  {
+    return -1;
+  }
+
+  // Withdraw from the old currency first
+  int old = p->group;
+  if (p->charged)
+  {
+    tgroups[old].active -= p->charged;
+    p->charged = 0;
+    group_reweight(old);
+  }
+
+  p->group = gid;
+  group_update(p);
+  if (p->rq_slot >= 0 && p->cpu >= 0 && p->cpu < ncpu)
+  {
+    rq_reweight(&cpus[p->cpu].rq, p); // Covers leaving to base tickets too
+  }
+  return 0;
+}
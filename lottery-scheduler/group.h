@@ -0,0 +1,24 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+// A ticket group: a named currency funded in base tickets. Members hold tickets
+// in the group's currency, so the group's share of the machine stays at its
+// funding however many members it has or forks.
+struct tgroup
+{
+  int used;      // Slot in use
+  char name[16]; // Group name
+  int funding;   // Base tickets backing the currency
+  int active;    // Currency tickets held by runnable or running members
+};
+
+extern struct tgroup tgroups[NGROUP];
+
+int group_tickets(struct proc *p);
+int proc_tickets(struct proc *p);
+void group_update(struct proc *p);
+int group_create(char *name, int funding);
+int group_fund(int gid, int funding);
+int group_join(struct proc *p, int gid);
+
+#endif
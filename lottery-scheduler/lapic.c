@@ -160,6 +160,16 @@ lapicstartap(uchar apicid, uint addr)
   }
 }
 
+// Send a fixed-vector interrupt to the CPU with the given APIC ID.
+void
+lapicipi(uchar apicid, int vector)
+{
+  lapicw(ICRHI, apicid<<24);
+  lapicw(ICRLO, FIXED | ASSERT | vector);
+  while(lapic[ICRLO] & DELIVS)
+    ;
+}
+
 #define CMOS_STATA   0x0a
 #define CMOS_STATB   0x0b
 #define CMOS_UIP    (1 << 7)        // RTC update in progress
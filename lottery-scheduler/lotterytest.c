@@ -11,8 +11,14 @@
  * 2. Basic Fairness: 8 processes with tickets 30, 30, 20, 20, 10, 10, 5, 5.
  * 3. Switch Overhead: 50 processes to test context switch performance.
  * 4. Starvation Check: 8 processes with tickets 50, 50, 10, 10, 1, 1, 1, 1.
- * 5. Grouped Ticket Levels: 30 processes in three groups (10 with 1 ticket, 10 with 5 tickets, 10 with 10 tickets).
+ * 5. Grouped Ticket Levels: 30 processes in three groups (10 with 1 ticket, 10 with 5 tickets, 10 with 10 tickets),
+ *    followed by a currency isolation check: two ticket groups with equal funding, one
+ *    with 1 process and one with 10 forked processes, should split the CPU evenly.
  * 6. Mixed Workload: 20 processes with different behaviors (CPU-heavy, I/O-bound, short-lived, mixed).
+ *
+ * Run as "lotterytest global" to use one machine-wide lottery, so the observed
+ * shares match ticket ratios on CPUS>1 as well, and/or "lotterytest stride" to
+ * run the same tests under deterministic stride scheduling.
  */
 
 #include "types.h"
@@ -448,6 +454,97 @@ void run_starvation_test(int *sched_a_out, int *sched_b_out, int *sched_c_out, i
     *sched_h_out = sched_h;
 }
 
+// Currency isolation check for Test 5: two ticket groups funded with 100 base tickets each
+// Group "solo" has 1 process; group "forker" has 10 processes forked from one member
+// Expected Proportions: solo=50%, forker=50%, since forking only dilutes the group's currency
+void run_group_isolation_check(void)
+{
+    int pids[11];
+    int sched_solo = 0, sched_forker = 0;
+    struct pinfo info[64];
+    int i;
+
+    int solo = mkgroup("solo", 100);
+    int forker = mkgroup("forker", 100);
+    if (solo < 0 || forker < 0)
+    {
+        printf(1, "  mkgroup failed\n");
+        return;
+    }
+
+    // Solo group: a single process
+    pids[0] = fork();
+    if (pids[0] == 0)
+    {
+        joingroup(getpid(), solo);
+        for (volatile int j = 0; j < 500000000; j++)
+        {
+            if (j % 5000 == 0)
+                yield();
+        }
+        exit();
+    }
+
+    // Forker group: join it ourselves so the children inherit it, then leave
+    joingroup(getpid(), forker);
+    for (i = 1; i < 11; i++)
+    {
+        pids[i] = fork();
+        if (pids[i] == 0)
+        {
+            for (volatile int j = 0; j < 500000000; j++)
+            {
+                if (j % 5000 == 0)
+                    yield();
+            }
+            exit();
+        }
+    }
+    joingroup(getpid(), -1);
+
+    sleep(50);
+
+    // Collect scheduling statistics
+    if (getpinfo(info) < 0)
+    {
+        printf(1, "getpinfo failed\n");
+    }
+    else
+    {
+        for (int j = 0; j < 64; j++)
+        {
+            if (info[j].pid == pids[0])
+                sched_solo += info[j].ticks_scheduled;
+            for (int k = 1; k < 11; k++)
+                if (info[j].pid == pids[k])
+                    sched_forker += info[j].ticks_scheduled;
+        }
+    }
+
+    // The measurement is done; stop the spinners instead of letting them finish
+    for (i = 0; i < 11; i++)
+    {
+        kill(pids[i]);
+    }
+    for (i = 0; i < 11; i++)
+    {
+        wait();
+    }
+
+    int total_sched = sched_solo + sched_forker;
+    if (total_sched > 0)
+    {
+        printf(1, "  Isolation: solo (1 proc) %d schedules (%d%%), forker (10 procs) %d schedules (%d%%)\n",
+               sched_solo, (sched_solo * 100) / total_sched,
+               sched_forker, (sched_forker * 100) / total_sched);
+        printf(1, "  Expected: solo=50%%, forker=50%%\n");
+    }
+    else
+    {
+        printf(1, "  Isolation: no scheduling data collected\n");
+    }
+}
+
 // Test 5: Evaluate scheduling with grouped ticket levels (30 processes)
 // Group 1: 10 processes with 1 ticket each (total 10 tickets)
 // Group 2: 10 processes with 5 tickets each (total 50 tickets)
@@ -556,6 +653,8 @@ void run_grouped_ticket_test(int *sched_group1_out, int *sched_group2_out, int *
         printf(1, "No scheduling data collected\n");
     }
 
+    run_group_isolation_check();
+
     *sched_group1_out = sched_group1;
     *sched_group2_out = sched_group2;
     *sched_group3_out = sched_group3;
@@ -701,6 +800,32 @@ int main(int argc, char *argv[])
 {
     printf(1, "Starting lottery scheduler tests\n");
 
+    // Optionally switch to the machine-wide lottery or to stride scheduling
+    int old_mode = -1, old_policy = -1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "global") == 0)
+        {
+            old_mode = setlotterymode(LOTTERY_GLOBAL);
+            if (old_mode < 0)
+            {
+                printf(1, "setlotterymode failed\n");
+                exit();
+            }
+            printf(1, "Using global lottery across all CPUs\n");
+        }
+        else if (strcmp(argv[i], "stride") == 0)
+        {
+            old_policy = setrqpolicy(-1, RQ_STRIDE);
+            if (old_policy < 0)
+            {
+                printf(1, "setrqpolicy failed\n");
+                exit();
+            }
+            printf(1, "Using stride scheduling on every runqueue\n");
+        }
+    }
+
     const int num_runs = 5; // Number of runs for each test to average results
     int total_a, total_b, total_c, total_d, total_e, total_f, total_g, total_h;
     int total_schedules;
@@ -992,7 +1117,25 @@ int main(int argc, char *argv[])
            total_d, percent_d_int, percent_d_dec);
     printf(1, "\n");
 
+    // Report how much work stealing moved processes between CPUs
+    struct cpuinfo cinfo[8];
+    int ncpus = getcpuinfo(cinfo);
+    for (int i = 0; i < ncpus; i++)
+    {
+        printf(1, "  CPU %d: %d migrations in, %d migrations out\n",
+               cinfo[i].cpu, cinfo[i].migrations_in, cinfo[i].migrations_out);
+    }
+
+    if (old_mode >= 0)
+    {
+        setlotterymode(old_mode);
+    }
+    if (old_policy >= 0)
+    {
+        setrqpolicy(-1, old_policy);
+    }
+
     printf(1, "\nAll tests complete\n");
     sleep(5);
     exit();
-}
\ No newline at end of file
+}
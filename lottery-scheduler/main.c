@@ -31,8 +31,8 @@ int main(void)
   binit();                                    // buffer cache
   fileinit();                                 // file table
   ideinit();                                  // disk
+  srand(42);                                  // Seed per-CPU RNGs
   startothers();                              // start other processors
-  srand(42);                                  // Seed RNG
   kinit2(P2V(4 * 1024 * 1024), P2V(PHYSTOP)); // must come after startothers()
   userinit();                                 // first user process
   mpmain();                                   // finish this processor's setup
@@ -11,4 +11,13 @@
 #define LOGSIZE      (MAXOPBLOCKS*3)  // max data blocks in on-disk log
 #define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
 #define FSSIZE       1000  // size of file system in blocks
-
+#define BALANCE_INTERVAL 10  // ticks between ticket load balancing passes
+#define BALANCE_TOLERANCE 25  // allowed per-CPU ticket imbalance, percent of the average
+#define BALANCE_MOVES  2  // most processes one balancing pass migrates
+#define LOTTERY_MODE  0  // lottery mode at boot: 0 per-CPU, 1 machine-wide
+#define RQ_POLICY     0  // runqueue policy at boot: 0 lottery, 1 stride
+#define NGROUP       16  // maximum number of ticket groups
+#define COMP_MIN_USED 10  // floor on quantum use in permille, caps compensation at 100x
+#define FORK_AFFINITY 10  // extra queued tickets tolerated to keep a child on its parent's CPU
+#define MAX_TICKETS 100000  // most tickets settickets accepts
+#define MAX_FUNDING 100000  // most base tickets backing one ticket group
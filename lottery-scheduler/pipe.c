@@ -17,6 +17,10 @@ struct pipe {
   uint nwrite;    // number of bytes written
   int readopen;   // read fd is still open
   int writeopen;  // write fd is still open
+  struct proc *reader;  // last process to read, lent tickets by blocked writers
+  struct proc *writer;  // last process to write, lent tickets by blocked readers
+  int readerpid;  // pid of reader, to detect a reused proc slot
+  int writerpid;  // pid of writer
 };
 
 int
@@ -34,6 +38,8 @@ pipealloc(struct file **f0, struct file **f1)
   p->writeopen = 1;
   p->nwrite = 0;
   p->nread = 0;
+  p->reader = p->writer = 0;
+  p->readerpid = p->writerpid = 0;
   initlock(&p->lock, "pipe");
   (*f0)->type = FD_PIPE;
   (*f0)->readable = 1;
@@ -81,6 +87,8 @@ pipewrite(struct pipe *p, char *addr, int n)
   int i;
 
   acquire(&p->lock);
+  p->writer = myproc();
+  p->writerpid = myproc()->pid;
   for(i = 0; i < n; i++){
     while(p->nwrite == p->nread + PIPESIZE){  //DOC: pipewrite-full
       if(p->readopen == 0 || myproc()->killed){
@@ -88,6 +96,7 @@ pipewrite(struct pipe *p, char *addr, int n)
         return -1;
       }
       wakeup(&p->nread);
+      lendtickets(p->reader, p->readerpid);  // until the reader drains the pipe
       sleep(&p->nwrite, &p->lock);  //DOC: pipewrite-sleep
     }
     p->data[p->nwrite++ % PIPESIZE] = addr[i];
@@ -108,8 +117,11 @@ piperead(struct pipe *p, char *addr, int n)
       release(&p->lock);
       return -1;
     }
+    lendtickets(p->writer, p->writerpid);  // until the writer fills the pipe
     sleep(&p->nread, &p->lock); //DOC: piperead-sleep
   }
+  p->reader = myproc();
+  p->readerpid = myproc()->pid;
   for(i = 0; i < n; i++){  //DOC: piperead-copy
     if(p->nread == p->nwrite)
       break;
@@ -6,12 +6,18 @@
  * context switching, and termination. The lottery scheduler uses per-CPU runqueues
  * to manage processes, with each process assigned a number of tickets to determine
  * its scheduling probability. A starvation prevention mechanism boosts tickets for
- * processes that have waited too long.
+ * processes that have waited too long. A CPU whose runqueue is empty steals a
+ * runnable process from the CPU with the most queued tickets, and a periodic
+ * balancer driven by the timer keeps per-CPU ticket totals close to each other.
+ * In LOTTERY_GLOBAL mode every CPU instead draws from the tickets queued on all
+ * CPUs, which enforces proportional share machine-wide. A process blocked on a
+ * pipe or in wait() lends its tickets to the process it is waiting on.
  *
  * Key Functions:
  * - pinit(): Initializes the process table and per-CPU runqueues.
  * - allocproc(): Allocates a new process structure.
  * - scheduler(): Main scheduling loop using lottery scheduling.
+ * - balance(): Periodic ticket-weighted load balancing across CPUs.
  * - fork(): Creates a new child process.
  * - exit(): Terminates the current process.
  * - wait(): Waits for a child process to terminate.
@@ -25,13 +31,18 @@
 #include "x86.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "traps.h"
 #include "runqueue.h"
 #include "rand.h"
+#include "group.h"
 
 // Global process table and lock
 struct proc ptable[NPROC];
 struct spinlock ptable_lock;
 
+// Current lottery mode, changed with setlotterymode (protected by ptable_lock)
+int lottery_mode = LOTTERY_MODE;
+
 // Initial process and next PID counter
 static struct proc *initproc;
 int nextpid = 1;
@@ -50,6 +61,8 @@ void pinit(void)
   for (int i = 0; i < ncpu; i++)
   {
     rq_init(&cpus[i].rq);
+    cpus[i].migrations_in = 0;
+    cpus[i].migrations_out = 0;
   }
 }
 
@@ -112,6 +125,18 @@ static struct proc *allocproc(void)
       p->last_scheduled = 0;   // Initialize last scheduled tick
       p->pid = nextpid++;      // Assign a new PID
       p->cpu = -1;             // Initially unassigned to any CPU
+      p->rq_slot = -1;         // Not queued on any runqueue yet
+      p->heap_slot = -1;
+      p->pass = 0;             // Start level with the queue it joins
+      p->group = -1;           // Holds base tickets until it joins a group
+      p->charged = 0;
+      p->donated = 0;          // No tickets lent to or by it yet
+      p->donee = 0;
+      p->donation = 0;
+      p->parent_donation = 0;
+      p->quantum_used = 1000;  // No compensation until it has run
+      p->preempted = 0;
+      p->migrations = 0;       // Initialize migration count
       release(&ptable_lock);
 
       // Allocate kernel stack
@@ -207,6 +232,32 @@ int growproc(int n)
   return 0;
 }
 
+// Choose a CPU for a new process from the per-runqueue ticket totals
+// The totals are read without locks as a hint, so placement is O(NCPU) and never
+// waits on a scheduler. The child stays on the parent's CPU, whose caches hold
+// the memory it was copied from, unless that CPU has more than FORK_AFFINITY
+// queued tickets above the lightest one.
+static int place_cpu(int parent_cpu)
+{
+  int best = 0, best_load = cpus[0].rq.total_tickets;
+  for (int i = 1; i < ncpu; i++)
+  {
+    int load = cpus[i].rq.total_tickets;
+    if (load < best_load)
+    {
+      best = i;
+      best_load = load;
+    }
+  }
+
+  if (parent_cpu >= 0 && parent_cpu < ncpu &&
+      cpus[parent_cpu].rq.total_tickets <= best_load + FORK_AFFINITY)
+  {
+    return parent_cpu;
+  }
+  return best;
+}
+
 // Create a new child process by duplicating the current process
 int fork(void)
 {
@@ -251,30 +302,13 @@ int fork(void)
 
   pid = np->pid;
   np->tickets = curproc->tickets; // Inherit parent's ticket count
+  np->group = curproc->group;     // ...in the parent's currency, so forking dilutes it
 
-  // Assign the new process to the CPU with the least total tickets
+  // Place the new process from the maintained runqueue totals, without locking them
+  int target_cpu = place_cpu(curproc->cpu);
   acquire(&ptable_lock);
-  int min_tickets = 999999;
-  int target_cpu = 0;
-  for (i = 0; i < ncpu; i++)
-  {
-    int cpu_tickets = 0;
-    acquire(&cpus[i].rq.lock);
-    for (int j = 0; j < cpus[i].rq.count; j++)
-    {
-      if (cpus[i].rq.procs[j])
-      {
-        cpu_tickets += cpus[i].rq.procs[j]->tickets;
-      }
-    }
-    release(&cpus[i].rq.lock);
-    if (cpu_tickets < min_tickets)
-    {
-      min_tickets = cpu_tickets;
-      target_cpu = i;
-    }
-  }
   np->state = RUNNABLE;
+  group_update(np);
   np->cpu = target_cpu;
   rq_add(&cpus[target_cpu].rq, np);
   release(&ptable_lock);
@@ -328,6 +362,7 @@ void exit(void)
 
   // Mark process as ZOMBIE and remove from runqueue
   curproc->state = ZOMBIE;
+  group_update(curproc);
   if (curproc->cpu < 0 || curproc->cpu >= ncpu)
   {
     panic("exit: invalid CPU assignment");
@@ -337,6 +372,104 @@ void exit(void)
   panic("zombie exit");
 }
 
+// Re-weight a process whose lent tickets changed, if it is queued
+// Caller holds ptable_lock
+static void reweight(struct proc *p)
+{
+  if (p->rq_slot >= 0 && p->cpu >= 0 && p->cpu < ncpu)
+  {
+    rq_reweight(&cpus[p->cpu].rq, p);
+  }
+}
+
+// Lend the current process's tickets to the process it is about to block on
+// Called just before sleep(), which takes them back on wakeup, so the lender's
+// share keeps working for it while it waits (e.g. a pipe client on its server)
+void lendtickets(struct proc *to, int pid)
+{
+  struct proc *p = myproc();
+
+  if (to == 0 || to == p)
+  {
+    return;
+  }
+
+  acquire(&ptable_lock);
+  if (p->donee == 0 && to->pid == pid && to->state != UNUSED && to->state != ZOMBIE)
+  {
+    p->donee = to;
+    p->doneepid = pid;
+    p->donation = proc_tickets(p);
+    to->donated += p->donation;
+    reweight(to);
+  }
+  release(&ptable_lock);
+}
+
+// Take back the tickets p lent when it blocked; caller holds ptable_lock
+static void reclaimtickets(struct proc *p)
+{
+  struct proc *to = p->donee;
+
+  // Skip a donee that exited and was reaped: its slot started over at zero
+  if (to->pid == p->doneepid && to->state != UNUSED)
+  {
+    to->donated -= p->donation;
+    reweight(to);
+  }
+  p->donee = 0;
+  p->donation = 0;
+}
+
+// Split a waiting parent's tickets among its live children
+// Caller holds ptable_lock
+static void lend_to_children(struct proc *parent)
+{
+  struct proc *p;
+  int nkids = 0;
+
+  for (p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->parent == parent && p->state != ZOMBIE && p->state != UNUSED)
+    {
+      nkids++;
+    }
+  }
+  if (nkids == 0)
+  {
+    return;
+  }
+
+  int share = proc_tickets(parent) / nkids;
+  if (share < 1)
+  {
+    share = 1;
+  }
+  for (p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->parent == parent && p->state != ZOMBIE && p->state != UNUSED)
+    {
+      p->parent_donation = share;
+      p->donated += share;
+      reweight(p);
+    }
+  }
+}
+
+// Take back the tickets lent by lend_to_children(); caller holds ptable_lock
+static void reclaim_from_children(struct proc *parent)
+{
+  for (struct proc *p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->parent == parent && p->parent_donation)
+    {
+      p->donated -= p->parent_donation;
+      p->parent_donation = 0;
+      reweight(p);
+    }
+  }
+}
+
 // Wait for a child process to terminate
 int wait(void)
 {
@@ -382,7 +515,196 @@ int wait(void)
       return -1;
     }
 
+    // Our children run on our tickets until one of them exits
+    lend_to_children(curproc);
     sleep(curproc, &ptable_lock);
+    reclaim_from_children(curproc);
+  }
+}
+
+// Find the CPU with the most queued tickets other than c, or 0 if all are empty
+// Reads the runqueues without locks; the result is only a hint for steal()
+static struct cpu *busiest_cpu(struct cpu *c)
+{
+  struct cpu *victim = 0;
+  for (struct cpu *v = cpus; v < &cpus[ncpu]; v++)
+  {
+    if (v == c || v->rq.count == 0)
+    {
+      continue;
+    }
+    if (victim == 0 || v->rq.total_tickets > victim->rq.total_tickets)
+    {
+      victim = v;
+    }
+  }
+  return victim;
+}
+
+// Record the move of a dequeued process from one CPU to another
+// Caller holds ptable_lock, which protects p->cpu and the migration counters
+static void migrate(struct proc *p, struct cpu *from, struct cpu *to)
+{
+  p->cpu = to - cpus;
+  p->migrations++;
+  from->migrations_out++;
+  to->migrations_in++;
+}
+
+// Migrate a ticket-weighted random process from victim's runqueue to c
+// Caller holds ptable_lock; the process is returned dequeued, ready to run on c
+static struct proc *steal(struct cpu *c, struct cpu *victim)
+{
+  struct proc *p = rq_steal(&victim->rq);
+  if (p == 0)
+  {
+    return 0; // Victim drained since busiest_cpu() looked at it
+  }
+  migrate(p, victim, c);
+  return p;
+}
+
+// Ticket mass of a CPU: its queued tickets plus those of the process it is running
+// Caller holds ptable_lock so c->proc cannot change underneath
+static int cpu_load(struct cpu *c)
+{
+  int load = c->rq.total_tickets;
+  if (c->proc)
+  {
+    load += proc_tickets(c->proc);
+  }
+  return load;
+}
+
+// Draw a winner from the tickets queued on every CPU and move it to c
+// Caller holds ptable_lock, which keeps every runqueue's total stable during the draw
+static struct proc *global_select(struct cpu *c)
+{
+  struct cpu *v;
+  int total = 0;
+  for (v = cpus; v < &cpus[ncpu]; v++)
+  {
+    total += v->rq.total_tickets;
+  }
+  if (total == 0)
+  {
+    return 0;
+  }
+
+  // Find the CPU holding the winning ticket, then draw within its runqueue
+  int winner = rand_range(total);
+  for (v = cpus; v < &cpus[ncpu] - 1; v++)
+  {
+    if (winner < v->rq.total_tickets)
+    {
+      break;
+    }
+    winner -= v->rq.total_tickets;
+  }
+  struct proc *p = rq_steal(&v->rq);
+  if (p && v != c)
+  {
+    migrate(p, v, c);
+  }
+  return p;
+}
+
+// Periodic ticket-weighted load balancer, called from the timer interrupt
+// Moves queued processes from the heaviest to the lightest CPU until every CPU's
+// ticket mass is within BALANCE_TOLERANCE percent of the machine-wide average.
+// Each pass moves at most BALANCE_MOVES, keeping the interrupt short; a large
+// imbalance is worked off over several intervals
+void balance(void)
+{
+  if (ncpu < 2 || lottery_mode == LOTTERY_GLOBAL)
+  {
+    return; // Nothing to balance, or every draw is machine-wide already
+  }
+
+  acquire(&ptable_lock);
+  for (int moves = 0; moves < BALANCE_MOVES; moves++)
+  {
+    struct cpu *max = cpus, *min = cpus;
+    int max_load = cpu_load(cpus), min_load = max_load, total = 0;
+    for (struct cpu *c = cpus; c < &cpus[ncpu]; c++)
+    {
+      int load = cpu_load(c);
+      total += load;
+      if (load > max_load)
+      {
+        max = c;
+        max_load = load;
+      }
+      if (load < min_load)
+      {
+        min = c;
+        min_load = load;
+      }
+    }
+
+    int slack = (total / ncpu) * BALANCE_TOLERANCE / 100;
+    if (max_load - min_load <= slack)
+    {
+      break; // Balanced within tolerance
+    }
+
+    // Move about half the gap; anything lighter than the gap narrows it
+    struct proc *p = rq_take(&max->rq, (max_load - min_load) / 2, max_load - min_load);
+    if (p == 0)
+    {
+      break; // Only the running process or oversized ones left on max
+    }
+    migrate(p, max, min);
+    rq_add(&min->rq, p);
+  }
+  release(&ptable_lock);
+}
+
+// True if c has nothing to run: its own runqueue is empty or, in the
+// machine-wide lottery, every runqueue is
+static int nothing_queued(struct cpu *c)
+{
+  if (lottery_mode != LOTTERY_GLOBAL)
+    return c->rq.count == 0;
+  for (struct cpu *v = cpus; v < &cpus[ncpu]; v++)
+  {
+    if (v->rq.count)
+      return 0;
+  }
+  return 1;
+}
+
+// Halt this CPU until the next interrupt: its timer tick, or the IPI
+// kick_idle() sends when work is queued here. idle is set before the last
+// look at the runqueues, so a CPU queueing work either sees idle set or
+// has its work seen.
+static void idle(struct cpu *c)
+{
+  cli();
+  xchg(&c->idle, 1);
+  if (nothing_queued(c))
+    sti_hlt();
+  else
+    sti();
+  c->idle = 0;
+}
+
+// rq has just gone from empty to non-empty: wake its CPU if it is halted
+// in idle(). In the machine-wide lottery rq_add() calls this whenever any
+// queue gains work, and any idle CPU can run it, so wake the first one.
+// Called with rq->lock held.
+void kick_idle(struct runqueue *rq)
+{
+  __sync_synchronize(); // Order the queue update before reading idle
+  for (struct cpu *c = cpus; c < &cpus[ncpu]; c++)
+  {
+    if (c == mycpu() || !c->idle)
+      continue;
+    if (&c->rq == rq || lottery_mode == LOTTERY_GLOBAL)
+    {
+      lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+      break;
+    }
   }
 }
 
@@ -413,34 +735,57 @@ void scheduler(void)
       release(&ptable_lock);
     }
 
-    // Select a process to run using lottery scheduling
-    p = rq_select(&c->rq, sched_count);
-    if (p == 0)
+    if (lottery_mode == LOTTERY_GLOBAL)
     {
-      // No process selected; check for any runnable processes
+      // One lottery over every CPU's tickets
       acquire(&ptable_lock);
-      int runnable_count = 0;
-      for (struct proc *proc = ptable; proc < &ptable[NPROC]; proc++)
+      p = global_select(c);
+      if (p == 0)
       {
-        if (proc->state == RUNNABLE && proc->cpu == c->apicid)
-        {
-          runnable_count++;
-        }
+        release(&ptable_lock);
+        idle(c); // Nothing runnable anywhere
+        continue;
       }
-      release(&ptable_lock);
-      sti(); // Re-enable interrupts
-      continue;
+    }
+    else if ((p = rq_select(&c->rq, sched_count)) == 0)
+    {
+      // Nothing queued locally; steal from the busiest CPU if there is one
+      struct cpu *victim = busiest_cpu(c);
+      if (victim == 0)
+      {
+        idle(c); // Nothing to steal either
+        continue;
+      }
+      acquire(&ptable_lock);
+      p = steal(c, victim);
+      if (p == 0)
+      {
+        release(&ptable_lock);
+        sti();
+        continue;
+      }
+    }
+    else
+    {
+      // Another CPU may have stolen p since rq_select released the queue
+      acquire(&ptable_lock);
+      if (p->state != RUNNABLE || p->cpu != c - cpus)
+      {
+        release(&ptable_lock);
+        sti();
+        continue;
+      }
+      rq_dispatch(&c->rq, p);
     }
 
     // Run the selected process
-    acquire(&ptable_lock);
-    rq_remove(&c->rq, p);
     c->proc = p;
     switchuvm(p);
     p->state = RUNNING;
     p->ticks_scheduled++;
     p->recent_schedules++;
     p->last_scheduled = ticks;
+    p->run_start = rdtsc();
     swtch(&(c->scheduler), p->context);
     switchkvm();
     c->proc = 0;
@@ -451,6 +796,34 @@ void scheduler(void)
   }
 }
 
+// Record the fraction of a tick the process ran for since it was last scheduled
+// Until its next win, rq_weight() inflates its tickets by the inverse of this.
+// Only voluntary departures are compensated: a process dispatched late in a
+// tick and preempted at the next one ran briefly but gave nothing up.
+static void account_quantum(struct proc *p)
+{
+  if (p->preempted)
+  {
+    p->preempted = 0;
+    p->quantum_used = 1000;
+    return;
+  }
+
+  uint tick = mycpu()->tick_tsc / 1000; // TSC cycles per permille of a tick
+  if (tick == 0)
+  {
+    p->quantum_used = 1000; // Tick length not measured yet
+    return;
+  }
+
+  uint used = (rdtsc() - p->run_start) / tick;
+  if (used > 1000)
+    used = 1000;
+  if (used < COMP_MIN_USED)
+    used = COMP_MIN_USED;
+  p->quantum_used = used;
+}
+
 // Context switch to the scheduler
 void sched(void)
 {
@@ -475,6 +848,9 @@ void sched(void)
     panic("sched interruptible");
   }
 
+  // Measure how much of its quantum the process used, for compensation tickets
+  account_quantum(p);
+
   // Add process back to runqueue if it's still runnable
   if (p->state == RUNNABLE)
   {
@@ -505,6 +881,13 @@ void yield(void)
   release(&ptable_lock);
 }
 
+// Give up the CPU because its quantum is over, from the timer interrupt
+void preempt(void)
+{
+  myproc()->preempted = 1;
+  yield();
+}
+
 // Handle return from fork in the child process
 void forkret(void)
 {
@@ -542,6 +925,7 @@ void sleep(void *chan, struct spinlock *lk)
   p->chan = chan;
   p->state = SLEEPING;
   p->recent_schedules = 0;
+  group_update(p);
   if (p->cpu < 0 || p->cpu >= ncpu)
   {
     panic("sleep: invalid CPU assignment");
@@ -552,6 +936,12 @@ void sleep(void *chan, struct spinlock *lk)
 
   p->chan = 0;
 
+  // Blocking is over; take back any tickets lent while asleep
+  if (p->donee)
+  {
+    reclaimtickets(p);
+  }
+
   // Release ptable_lock if necessary
   if (lk != &ptable_lock)
   {
@@ -571,6 +961,7 @@ static void wakeup1(void *chan)
     {
       p->state = RUNNABLE;
       p->recent_schedules = 0;
+      group_update(p);
       if (p->cpu < 0 || p->cpu >= ncpu)
       {
         panic("wakeup1: invalid CPU assignment");
@@ -602,6 +993,7 @@ int kill(int pid)
       if (p->state == SLEEPING)
       {
         p->state = RUNNABLE;
+        group_update(p);
         if (p->cpu < 0 || p->cpu >= ncpu)
         {
           panic("kill: invalid CPU assignment");
@@ -657,4 +1049,6 @@ void procdump(void)
     }
     cprintf("\n");
   }
+  for (i = 0; i < ncpu; i++)
+    cprintf("cpu%d: idle %d ticks\n", i, cpus[i].idle_ticks);
 }
\ No newline at end of file
@@ -6,7 +6,8 @@
  * definitions for the per-CPU state, process state, and process table.
  *
  * Key Structures:
- * - struct cpu: Represents per-CPU state, including the runqueue for lottery scheduling.
+ * - struct cpu: Represents per-CPU state, including the runqueue for lottery scheduling
+ *   and migration counters for work stealing.
  * - struct proc: Represents a process, including its scheduling parameters (tickets, ticks_scheduled).
  * - struct context: Defines the saved registers for context switching.
  *
@@ -23,6 +24,11 @@
 // Global spinlock for the process table
 struct spinlock ptable_lock;
 
+// Lottery modes (see setlotterymode)
+#define LOTTERY_PERCPU 0 // Each CPU draws a winner from its own runqueue
+#define LOTTERY_GLOBAL 1 // Each CPU draws a winner from the tickets of all runqueues
+extern int lottery_mode;
+
 // Per-CPU state structure
 struct cpu
 {
@@ -35,6 +41,14 @@ struct cpu
   int intena;                // Were interrupts enabled before pushcli?
   struct proc *proc;         // The currently running process on this CPU
   struct runqueue rq;        // Per-CPU runqueue for lottery scheduling
+  uint migrations_in;        // Processes migrated onto this CPU (protected by ptable_lock)
+  uint migrations_out;       // Processes migrated away from this CPU (protected by ptable_lock)
+  uint last_tick_tsc;        // TSC at the previous timer interrupt
+  uint tick_tsc;             // Length of a timer tick in TSC cycles (0 until measured)
+  uint rand_state;           // Per-CPU random number generator state for lottery draws
+  uint rand_gen;             // Seed generation rand_state was last seeded from
+  volatile uint idle;        // Halted in the idle loop
+  uint idle_ticks;           // Timer ticks spent idle
 };
 
 // Global array of CPUs and count
@@ -82,6 +96,20 @@ struct proc
   int ticks_scheduled;        // Number of times the process has been scheduled
   int recent_schedules;       // Recent scheduling count (used for decay in scheduler)
   int cpu;                    // CPU on which the process is assigned (-1 if unassigned)
+  int rq_slot;                // Slot in its CPU's runqueue (-1 if not queued)
+  int heap_slot;              // Slot in its CPU's stride heap (-1 if not queued)
+  uint pass;                  // Stride pass (lag behind the queue's min_pass while not queued)
+  int group;                  // Ticket group whose currency tickets are in (-1 for base tickets)
+  int charged;                // Tickets counted in the group's active total
+  int donated;                // Base tickets lent by processes blocked on this one
+  struct proc *donee;         // Process this one lent its tickets to while blocked
+  int doneepid;               // Pid of donee, to detect a reused slot
+  int donation;               // Base tickets lent to donee
+  int parent_donation;        // Base tickets lent by the parent while it waits
+  uint run_start;             // TSC when the process last started running
+  int quantum_used;           // Permille of its last quantum it used (1000 = all of it)
+  int preempted;              // Leaving the CPU at a timer tick, not of its own accord
+  int migrations;             // Number of times the process moved to another CPU
   uint last_scheduled;        // Last tick when the process was scheduled
 };
 
@@ -1,33 +1,52 @@
 #include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "proc.h"
 #include "rand.h"
 
-// Define the random number generator state
-unsigned int randstate = 1;
+static unsigned int seed;              // Last seed passed to srand()
+static volatile unsigned int seed_gen; // Bumped by each srand()
 
-void srand(unsigned int seed)
+// Seed every CPU's generator from one seed so runs are reproducible
+// Only publishes the seed: each CPU applies it to its own state before its
+// next draw, so a draw in progress on another CPU cannot overwrite it
+void srand(unsigned int s)
 {
-    randstate = seed;
-    if (randstate == 0)
-        randstate = 1;
+    seed = s;
+    __sync_synchronize(); // Publish the seed before its generation
+    __sync_fetch_and_add(&seed_gen, 1);
 }
 
-unsigned int rand(void)
+// Advance this CPU's xorshift32 state and return all 32 bits
+// A CPU that has not seen the latest seed first derives a distinct, non-zero
+// state from it
+static unsigned int rand32(void)
 {
-    unsigned int x = randstate;
+    struct cpu *c = mycpu();
+    unsigned int gen = seed_gen;
+    if (c->rand_gen != gen)
+    {
+        __sync_synchronize(); // Read the generation before its seed
+        unsigned int x = seed ^ ((c - cpus + 1) * 0x9e3779b9);
+        c->rand_state = x ? x : 1;
+        c->rand_gen = gen;
+    }
+    unsigned int x = c->rand_state;
     x ^= (x << 13);
     x ^= (x >> 17);
     x ^= (x << 5);
-    randstate = x;
-    return x & 0x7fffffff;
+    c->rand_state = x;
+    return x;
+}
+
+unsigned int rand(void)
+{
+    return rand32() & 0x7fffffff;
 }
 
+// Uniform-enough number in [0, max) with one multiply and no division
+// Scales a 32-bit draw into the range (bias below max / 2^32)
 unsigned int rand_range(unsigned int max)
 {
-    unsigned int threshold = (0x7fffffff / max) * max;
-    unsigned int r;
-    do
-    {
-        r = rand();
-    } while (r >= threshold);
-    return r % max;
-}
\ No newline at end of file
+    return ((unsigned long long)rand32() * max) >> 32;
+}
@@ -1,11 +1,12 @@
 #ifndef RAND_H
 #define RAND_H
 
-// Declare the random number generator state as extern
-extern unsigned int randstate;
+// Each CPU keeps its own generator state in struct cpu (rand_state), so draws
+// on different CPUs neither race nor share a cache line. Call rand() and
+// rand_range() with interrupts disabled, e.g. while holding a spinlock.
 
 void srand(unsigned int seed);
 unsigned int rand(void);
 unsigned int rand_range(unsigned int max);
 
-#endif
\ No newline at end of file
+#endif
@@ -8,6 +8,15 @@
  * Key Features:
  * - Per-CPU runqueues for scalability in multi-CPU setups.
  * - Lottery scheduling: Processes are selected probabilistically based on ticket counts.
+ * - Ticket counts are kept in a Fenwick (binary indexed) tree keyed on slot index,
+ *   so adding, removing and re-ticketing a process and drawing a winner are all
+ *   O(log n) instead of several linear passes per scheduling decision.
+ * - Stride scheduling: a runqueue can instead run the process with the smallest
+ *   pass from a min-heap, advancing its pass by STRIDE1 / tickets on each win.
+ *   Passes are stored relative to the queue's min_pass while a process is off the
+ *   queue, so sleepers and migrated processes rejoin without credit or penalty.
+ * - Compensation tickets: processes that give up the CPU early are weighted up
+ *   in proportion to the part of the quantum they left unused.
  */
 
 #include "types.h"
@@ -15,21 +24,127 @@
 #include "proc.h"
 #include "runqueue.h"
 #include "rand.h"
+#include "group.h"
+#include "x86.h"
+
+// Largest power of two not exceeding MAX_PROCS, used as the first descent step
+#define RQ_TREE_TOP 64
+
+// Effective ticket count of a process in base tickets (at least one),
+// including tickets lent to it by blocked processes and compensation tickets:
+// a process that used only a fraction f of its last quantum competes with 1/f
+// times its tickets until it wins again.  Computed in 64 bits and capped at
+// RQ_MAX_WEIGHT: compensation alone multiplies tickets by up to 100.
+static int rq_weight(struct proc *p)
+{
+    uint64 w = (uint64)proc_tickets(p) * 1000;
+
+    if (w >= (uint64)RQ_MAX_WEIGHT * p->quantum_used)
+    {
+        return RQ_MAX_WEIGHT;
+    }
+    return divl(w, p->quantum_used);
+}
+
+// Add delta tickets to slot i in the Fenwick tree
+static void rq_tree_update(struct runqueue *rq, int i, int delta)
+{
+    for (i++; i <= MAX_PROCS; i += i & -i)
+    {
+        rq->tree[i] += delta;
+    }
+    rq->total_tickets += delta;
+}
+
+// Set the tickets charged to slot i, keeping the tree consistent
+static void rq_set_slot(struct runqueue *rq, int i, int tickets)
+{
+    rq_tree_update(rq, i, tickets - rq->tickets[i]);
+    rq->tickets[i] = tickets;
+}
+
+// Find the slot owning ticket number winner (0 <= winner < total_tickets)
+// Descends the tree from the top, one level per step
+static int rq_tree_find(struct runqueue *rq, int winner)
+{
+    int pos = 0;
+    for (int step = RQ_TREE_TOP; step > 0; step >>= 1)
+    {
+        if (pos + step <= MAX_PROCS && rq->tree[pos + step] <= winner)
+        {
+            pos += step;
+            winner -= rq->tree[pos];
+        }
+    }
+    return pos; // 1-indexed position pos+1, i.e. slot pos
+}
+
+// True if a runs before b under stride scheduling (safe across pass wrap-around)
+static int rq_pass_before(struct proc *a, struct proc *b)
+{
+    return (int)(a->pass - b->pass) < 0;
+}
+
+// Swap two heap entries and update their back-pointers
+static void rq_heap_swap(struct runqueue *rq, int i, int j)
+{
+    struct proc *t = rq->heap[i];
+    rq->heap[i] = rq->heap[j];
+    rq->heap[j] = t;
+    rq->heap[i]->heap_slot = i;
+    rq->heap[j]->heap_slot = j;
+}
+
+// Move heap entry i towards the root while it has a smaller pass than its parent
+static void rq_heap_up(struct runqueue *rq, int i)
+{
+    while (i > 0 && rq_pass_before(rq->heap[i], rq->heap[(i - 1) / 2]))
+    {
+        rq_heap_swap(rq, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+// Move heap entry i towards the leaves while a child has a smaller pass
+static void rq_heap_down(struct runqueue *rq, int i)
+{
+    for (;;)
+    {
+        int min = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < rq->count && rq_pass_before(rq->heap[l], rq->heap[min]))
+            min = l;
+        if (r < rq->count && rq_pass_before(rq->heap[r], rq->heap[min]))
+            min = r;
+        if (min == i)
+            return;
+        rq_heap_swap(rq, i, min);
+        i = min;
+    }
+}
 
 // Initialize a runqueue for a CPU
-// Sets up the spinlock and clears the process array
+// Sets up the spinlock and clears the process array, ticket tree and heap
 void rq_init(struct runqueue *rq)
 {
     initlock(&rq->lock, "runqueue");
     rq->count = 0;
+    rq->total_tickets = 0;
+    rq->min_pass = 0;
+    rq->policy = RQ_POLICY;
     for (int i = 0; i < MAX_PROCS; i++)
     {
         rq->procs[i] = 0;
+        rq->tickets[i] = 0;
+        rq->heap[i] = 0;
+    }
+    for (int i = 0; i <= MAX_PROCS; i++)
+    {
+        rq->tree[i] = 0;
     }
 }
 
 // Add a process to the runqueue
-// Finds the first empty slot and adds the process, panics if the runqueue is full
+// Processes are packed, so the first empty slot is always slot count; panics if full
 void rq_add(struct runqueue *rq, struct proc *p)
 {
     acquire(&rq->lock);
@@ -37,39 +152,109 @@ void rq_add(struct runqueue *rq, struct proc *p)
     {
         panic("runqueue full");
     }
-    for (int i = 0; i < MAX_PROCS; i++)
+    int i = rq->count++;
+    rq->procs[i] = p;
+    p->rq_slot = i;
+    rq_set_slot(rq, i, rq_weight(p));
+
+    // Rejoin the queue's virtual time with the lag the process left with
+    p->pass += rq->min_pass;
+    rq->heap[i] = p;
+    p->heap_slot = i;
+    rq_heap_up(rq, i);
+
+    // An empty queue's CPU may be halted in idle(); in the machine-wide
+    // lottery any halted CPU can run p, so wake one whenever work arrives
+    if (rq->count == 1 || lottery_mode == LOTTERY_GLOBAL)
+        kick_idle(rq);
+    release(&rq->lock);
+}
+
+// Unlink a process from the runqueue; caller holds rq->lock
+// Moves the last process into the removed slot so the array stays packed
+static void rq_unlink(struct runqueue *rq, struct proc *p)
+{
+    int i = p->rq_slot;
+    if (i < 0 || i >= rq->count || rq->procs[i] != p)
     {
-        if (rq->procs[i] == 0)
-        {
-            rq->procs[i] = p;
-            rq->count++;
-            break;
-        }
+        return; // Not queued here
     }
-    release(&rq->lock);
+
+    int last = rq->count - 1;
+    if (i != last)
+    {
+        struct proc *moved = rq->procs[last];
+        rq->procs[i] = moved;
+        moved->rq_slot = i;
+        rq_set_slot(rq, i, rq->tickets[last]);
+    }
+    rq_set_slot(rq, last, 0);
+    rq->procs[last] = 0;
+
+    // Fill the hole in the heap with its last entry and restore heap order
+    int h = p->heap_slot;
+    struct proc *tail = rq->heap[last];
+    rq->heap[last] = 0;
+    rq->count--;
+    if (h != last)
+    {
+        rq->heap[h] = tail;
+        tail->heap_slot = h;
+        rq_heap_up(rq, h);
+        rq_heap_down(rq, tail->heap_slot);
+    }
+    p->rq_slot = -1;
+    p->heap_slot = -1;
+    p->pass -= rq->min_pass; // Keep only the lag while off the queue
 }
 
 // Remove a process from the runqueue
-// Optimized to move the last process to the removed slot instead of shifting all processes
 void rq_remove(struct runqueue *rq, struct proc *p)
 {
     acquire(&rq->lock);
-    for (int i = 0; i < MAX_PROCS; i++)
+    rq_unlink(rq, p);
+    release(&rq->lock);
+}
+
+// Remove the process the scheduler is about to run
+// Under stride scheduling this is where it pays its stride, so a process that
+// was selected but stolen before it ran is not charged
+void rq_dispatch(struct runqueue *rq, struct proc *p)
+{
+    acquire(&rq->lock);
+    int i = p->rq_slot;
+    if (rq->policy == RQ_STRIDE && i >= 0 && i < rq->count && rq->procs[i] == p)
     {
-        if (rq->procs[i] == p)
-        {
-            // Move the last process to the current slot to avoid shifting
-            rq->procs[i] = rq->procs[rq->count - 1];
-            rq->procs[rq->count - 1] = 0;
-            rq->count--;
-            break;
-        }
+        rq->min_pass = rq->heap[0]->pass;
+        int stride = STRIDE1 / rq_weight(p);
+        p->pass += stride < 1 ? 1 : stride; // Always advance, however heavy
     }
+    rq_unlink(rq, p);
     release(&rq->lock);
 }
 
-// Select a process to run using lottery scheduling
-// Returns a process based on ticket proportions
+// Recompute the weight of a queued process after its tickets' value changed
+void rq_reweight(struct runqueue *rq, struct proc *p)
+{
+    acquire(&rq->lock);
+    int i = p->rq_slot;
+    if (i >= 0 && i < rq->count && rq->procs[i] == p)
+    {
+        rq_set_slot(rq, i, rq_weight(p));
+    }
+    release(&rq->lock);
+}
+
+// Change the ticket count of a process, re-weighting its slot if it is queued
+void rq_settickets(struct runqueue *rq, struct proc *p, int tickets)
+{
+    p->tickets = tickets;
+    rq_reweight(rq, p);
+}
+
+// Select a process to run using the runqueue's policy, leaving it queued
+// Lottery draws one random ticket and finds its owner with a single tree descent;
+// stride takes the heap minimum, which rq_dispatch() charges if it runs
 struct proc *rq_select(struct runqueue *rq, int sched_count)
 {
     acquire(&rq->lock);
@@ -79,79 +264,90 @@ struct proc *rq_select(struct runqueue *rq, int sched_count)
         return 0; // No processes to schedule
     }
 
-    // Step 1: Calculate total tickets
-    int total_tickets = 0;
-    for (int i = 0; i < MAX_PROCS; i++)
+    if (rq->policy == RQ_STRIDE)
     {
-        if (rq->procs[i])
-        {
-            struct proc *p = rq->procs[i];
-            int effective_tickets = p->tickets;
-            if (effective_tickets < 1)
-                effective_tickets = 1; // Ensure at least 1 ticket
-            total_tickets += effective_tickets;
-        }
+        struct proc *p = rq->heap[0];
+        release(&rq->lock);
+        return p;
     }
 
     // Debug check: This should never happen since count > 0
-    if (total_tickets == 0)
+    if (rq->total_tickets <= 0)
     {
-        cprintf("rq_select: total_tickets = 0 despite count = %d\n", rq->count);
+        cprintf("rq_select: total_tickets = %d despite count = %d\n",
+                rq->total_tickets, rq->count);
         release(&rq->lock);
         return 0;
     }
 
-    // Step 2: Create a temporary array of processes for shuffling
-    struct proc *temp_procs[MAX_PROCS];
-    int temp_count = 0;
-    for (int i = 0; i < MAX_PROCS; i++)
+    int winner = rand_range(rq->total_tickets);
+    struct proc *selected = rq->procs[rq_tree_find(rq, winner)];
+
+    release(&rq->lock);
+    return selected;
+}
+
+// Remove a process from the runqueue for migration to another CPU
+// The victim is drawn by lottery, so high-ticket processes move more often;
+// a stride queue gives up the process that would have run next
+struct proc *rq_steal(struct runqueue *rq)
+{
+    acquire(&rq->lock);
+    if (rq->count == 0 || rq->total_tickets <= 0)
     {
-        if (rq->procs[i])
-        {
-            temp_procs[temp_count++] = rq->procs[i];
-        }
+        release(&rq->lock);
+        return 0; // Nothing to steal
     }
 
-    // Step 3: Map APIC ID to CPU ID for random number generation
-    int cpu_id = lapicid();
-    for (int i = 0; i < ncpu; i++)
+    struct proc *p;
+    if (rq->policy == RQ_STRIDE)
+        p = rq->heap[0];
+    else
+        p = rq->procs[rq_tree_find(rq, rand_range(rq->total_tickets))];
+    rq_unlink(rq, p);
+
+    release(&rq->lock);
+    return p;
+}
+
+// Remove the queued process whose tickets are closest to want but below limit
+// Used by the load balancer to move just enough ticket mass between CPUs
+struct proc *rq_take(struct runqueue *rq, int want, int limit)
+{
+    acquire(&rq->lock);
+    int best = -1, best_diff = 0;
+    for (int i = 0; i < rq->count; i++)
     {
-        if (cpus[i].apicid == cpu_id)
+        int t = rq->tickets[i];
+        if (t >= limit)
         {
-            cpu_id = i;
-            break;
+            continue; // Moving it would not narrow the gap
+        }
+        int diff = t > want ? t - want : want - t;
+        if (best < 0 || diff < best_diff)
+        {
+            best = i;
+            best_diff = diff;
         }
     }
 
-    // Step 4: Shuffle the process array to avoid bias in selection
-    for (int i = temp_count - 1; i > 0; i--)
-    {
-        int j = rand_range(i + 1);
-        struct proc *temp = temp_procs[i];
-        temp_procs[i] = temp_procs[j];
-        temp_procs[j] = temp;
-    }
-
-    // Step 5: Select a winner based on ticket proportions
-    int winner = rand_range(total_tickets);
-    int current_tickets = 0;
-    struct proc *selected = 0;
-    for (int i = 0; i < temp_count; i++)
+    struct proc *p = 0;
+    if (best >= 0)
     {
-        struct proc *p = temp_procs[i];
-        int effective_tickets = p->tickets;
-        if (effective_tickets < 1)
-            effective_tickets = 1;
-
-        // Check if the random winner falls within this process's ticket range
-        if (winner < effective_tickets + current_tickets)
-        {
-            selected = p;
-            break;
-        }
-        current_tickets += effective_tickets;
+        p = rq->procs[best];
+        rq_unlink(rq, p);
     }
+    release(&rq->lock);
+    return p;
+}
 
+// Switch the runqueue between lottery and stride scheduling
+// Both structures are always maintained, so the switch takes effect immediately
+int rq_setpolicy(struct runqueue *rq, int policy)
+{
+    acquire(&rq->lock);
+    int old = rq->policy;
+    rq->policy = policy;
     release(&rq->lock);
-    return selected;
-}
\ No newline at end of file
+    return old;
+}
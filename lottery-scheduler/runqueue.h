@@ -5,9 +5,25 @@
 
 #define MAX_PROCS 64
 
+// Runqueue policies (see setrqpolicy)
+#define RQ_LOTTERY 0 // Draw a random winner weighted by tickets
+#define RQ_STRIDE 1  // Run the process with the smallest pass, deterministically
+
+// Pass advance for a one-ticket process; a process with t tickets advances STRIDE1 / t
+#define STRIDE1 (1 << 20)
+
+// Cap on a process's effective tickets, so MAX_PROCS of them sum to an int
+#define RQ_MAX_WEIGHT (1 << 24)
+
 struct runqueue
 {
-    struct proc *procs[MAX_PROCS];
+    struct proc *procs[MAX_PROCS]; // Queued processes, packed into slots [0, count)
+    int tickets[MAX_PROCS];        // Tickets charged to each slot
+    int tree[MAX_PROCS + 1];       // Fenwick tree of slot tickets (1-indexed)
+    int total_tickets;             // Sum of tickets over all slots
+    struct proc *heap[MAX_PROCS];  // Min-heap on pass over the same processes
+    uint min_pass;                 // Pass of the last stride winner (queue virtual time)
+    int policy;                    // RQ_LOTTERY or RQ_STRIDE
     int count;
     struct spinlock lock;
 };
@@ -15,6 +31,12 @@ struct runqueue
 void rq_init(struct runqueue *rq);
 void rq_add(struct runqueue *rq, struct proc *p);
 void rq_remove(struct runqueue *rq, struct proc *p);
+void rq_dispatch(struct runqueue *rq, struct proc *p);
+void rq_reweight(struct runqueue *rq, struct proc *p);
+void rq_settickets(struct runqueue *rq, struct proc *p, int tickets);
 struct proc *rq_select(struct runqueue *rq, int sched_count);
+struct proc *rq_steal(struct runqueue *rq);
+struct proc *rq_take(struct runqueue *rq, int want, int limit);
+int rq_setpolicy(struct runqueue *rq, int policy);
 
-#endif
\ No newline at end of file
+#endif
@@ -103,6 +103,13 @@ extern int sys_settickets(void);
 extern int sys_getpinfo(void);
 extern int sys_yield(void);
 extern int sys_settickets_pid(void);
+extern int sys_getcpuinfo(void);
+extern int sys_setlotterymode(void);
+extern int sys_setrqpolicy(void);
+extern int sys_mkgroup(void);
+extern int sys_fundgroup(void);
+extern int sys_joingroup(void);
+extern int sys_seedrand(void);
 
 static int (*syscalls[])(void) = {
     [SYS_fork] sys_fork,
@@ -130,6 +137,13 @@ static int (*syscalls[])(void) = {
     [SYS_getpinfo] sys_getpinfo,
     [SYS_yield] sys_yield,
     [SYS_settickets_pid] sys_settickets_pid,
+    [SYS_setlotterymode] sys_setlotterymode,
+    [SYS_getcpuinfo] sys_getcpuinfo,
+    [SYS_mkgroup] sys_mkgroup,
+    [SYS_setrqpolicy] sys_setrqpolicy,
+    [SYS_joingroup] sys_joingroup,
+    [SYS_fundgroup] sys_fundgroup,
+    [SYS_seedrand] sys_seedrand,
 };
 
 void syscall(void)
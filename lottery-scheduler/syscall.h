@@ -23,4 +23,11 @@
 #define SYS_settickets 22
 #define SYS_getpinfo 23
 #define SYS_yield 24
-#define SYS_settickets_pid 25
\ No newline at end of file
+#define SYS_settickets_pid 25
+#define SYS_getcpuinfo 26
+#define SYS_setlotterymode 27
+#define SYS_setrqpolicy 28
+#define SYS_mkgroup 29
+#define SYS_fundgroup 30
+#define SYS_joingroup 31
+#define SYS_seedrand 32
\ No newline at end of file
@@ -19,6 +19,13 @@
  * - sys_getpinfo: Retrieves scheduling statistics for all processes.
  * - sys_yield: Yields the CPU to another process.
  * - sys_settickets_pid: Sets the ticket count for a process by PID.
+ * - sys_getcpuinfo: Retrieves per-CPU runqueue and migration statistics.
+ * - sys_setlotterymode: Switches between per-CPU and machine-wide lotteries.
+ * - sys_setrqpolicy: Switches a CPU's runqueue between lottery and stride scheduling.
+ * - sys_mkgroup: Creates a ticket group (currency) funded with base tickets.
+ * - sys_fundgroup: Changes the base tickets backing a ticket group.
+ * - sys_joingroup: Moves a process into a ticket group.
+ * - sys_seedrand: Reseeds the per-CPU random number generators.
  */
 
 #include "types.h"
@@ -28,6 +35,8 @@
 #include "mmu.h"
 #include "x86.h"
 #include "proc.h"
+#include "group.h"
+#include "rand.h"
 
 // Process information structure matching user.h for getpinfo system call
 struct pinfo
@@ -35,6 +44,17 @@ struct pinfo
   int pid;             // Process ID
   int tickets;         // Number of lottery tickets
   int ticks_scheduled; // Number of times scheduled
+  int migrations;      // Number of moves to another CPU
+};
+
+// Per-CPU information structure matching user.h for getcpuinfo system call
+struct cpuinfo
+{
+  int cpu;            // CPU index
+  int queued;         // Processes waiting in the CPU's runqueue
+  int tickets;        // Total tickets in the CPU's runqueue
+  int migrations_in;  // Processes migrated onto the CPU
+  int migrations_out; // Processes migrated away from the CPU
 };
 
 // External references to the process table and its lock
@@ -195,7 +215,7 @@ int sys_uptime(void)
  *
  * Parameters:
  * - tickets (via argint): Number of lottery tickets to assign.
- * Returns: 0 on success, -1 if tickets is non-positive or invalid.
+ * Returns: 0 on success, -1 if tickets is non-positive, above MAX_TICKETS or invalid.
  */
 int sys_settickets(void)
 {
@@ -203,14 +223,15 @@ int sys_settickets(void)
   struct proc *curproc = myproc();
 
   // Validate the ticket count
-  if (argint(0, &tickets) < 0 || tickets <= 0)
+  if (argint(0, &tickets) < 0 || tickets <= 0 || tickets > MAX_TICKETS)
   {
-    return -1; // Invalid or non-positive tickets
+    return -1; // Invalid, non-positive or too many tickets
   }
 
   // Update the process's ticket count under lock
   acquire(&ptable_lock);
-  curproc->tickets = tickets;
+  rq_settickets(&cpus[curproc->cpu].rq, curproc, tickets);
+  group_update(curproc);
   release(&ptable_lock);
 
   return 0;
@@ -244,12 +265,14 @@ int sys_getpinfo(void)
       info[i].pid = p->pid;
       info[i].tickets = p->tickets;
       info[i].ticks_scheduled = p->ticks_scheduled;
+      info[i].migrations = p->migrations;
     }
     else
     { // Unused process slot
       info[i].pid = 0;
       info[i].tickets = 0;
       info[i].ticks_scheduled = 0;
+      info[i].migrations = 0;
     }
   }
   release(&ptable_lock);
@@ -283,7 +306,7 @@ int sys_settickets_pid(void)
   struct proc *p;
 
   // Validate PID and ticket count
-  if (argint(0, &pid) < 0 || argint(1, &tickets) < 0 || tickets <= 0)
+  if (argint(0, &pid) < 0 || argint(1, &tickets) < 0 || tickets <= 0 || tickets > MAX_TICKETS)
   {
     return -1; // Invalid arguments
   }
@@ -294,7 +317,12 @@ int sys_settickets_pid(void)
   {
     if (p->pid == pid)
     {
-      p->tickets = tickets;
+      // Re-weight the runqueue slot too if the process is queued
+      if (p->cpu >= 0 && p->cpu < ncpu)
+        rq_settickets(&cpus[p->cpu].rq, p, tickets);
+      else
+        p->tickets = tickets;
+      group_update(p);
       release(&ptable_lock);
       return 0; // Success
     }
@@ -302,4 +330,206 @@ int sys_settickets_pid(void)
   release(&ptable_lock);
 
   return -1; // PID not found
-}
\ No newline at end of file
+}
+
+/*
+ * sys_getcpuinfo - Retrieve per-CPU runqueue and migration statistics
+ *
+ * Parameters:
+ * - info (via argptr): Pointer to an array of struct cpuinfo for NCPU CPUs.
+ * Returns: Number of CPUs filled in on success, -1 if the pointer is invalid.
+ */
+int sys_getcpuinfo(void)
+{
+  struct cpuinfo *info;
+
+  // Validate the user-provided pointer
+  if (argptr(0, (void *)&info, sizeof(*info) * NCPU) < 0)
+  {
+    return -1; // Invalid pointer
+  }
+
+  // Migration counters are protected by ptable_lock
+  acquire(&ptable_lock);
+  for (int i = 0; i < ncpu; i++)
+  {
+    struct cpu *c = &cpus[i];
+    acquire(&c->rq.lock);
+    info[i].cpu = i;
+    info[i].queued = c->rq.count;
+    info[i].tickets = c->rq.total_tickets;
+    release(&c->rq.lock);
+    info[i].migrations_in = c->migrations_in;
+    info[i].migrations_out = c->migrations_out;
+  }
+  release(&ptable_lock);
+
+  return ncpu;
+}
+
+/*
+ * sys_setlotterymode - Switch between per-CPU and machine-wide lotteries
+ *
+ * Parameters:
+ * - mode (via argint): LOTTERY_PERCPU or LOTTERY_GLOBAL.
+ * Returns: The previous mode on success, -1 if the mode is invalid.
+ */
+int sys_setlotterymode(void)
+{
+  int mode, old;
+
+  if (argint(0, &mode) < 0 || (mode != LOTTERY_PERCPU && mode != LOTTERY_GLOBAL))
+  {
+    return -1; // Invalid mode
+  }
+
+  acquire(&ptable_lock);
+  old = lottery_mode;
+  lottery_mode = mode;
+  release(&ptable_lock);
+
+  return old;
+}
+
+/*
+ * sys_setrqpolicy - Switch runqueues between lottery and stride scheduling
+ *
+ * Parameters:
+ * - cpu (via argint): CPU index, or -1 for every CPU.
+ * - policy (via argint): RQ_LOTTERY or RQ_STRIDE.
+ * Returns: The previous policy of the CPU (of CPU 0 when cpu is -1), or -1 on
+ * invalid arguments.
+ */
+int sys_setrqpolicy(void)
+{
+  int cpu, policy, old;
+
+  if (argint(0, &cpu) < 0 || argint(1, &policy) < 0 ||
+      cpu < -1 || cpu >= ncpu || (policy != RQ_LOTTERY && policy != RQ_STRIDE))
+  {
+    return -1; // Invalid arguments
+  }
+
+  if (cpu >= 0)
+  {
+    return rq_setpolicy(&cpus[cpu].rq, policy);
+  }
+
+  old = rq_setpolicy(&cpus[0].rq, policy);
+  for (int i = 1; i < ncpu; i++)
+  {
+    rq_setpolicy(&cpus[i].rq, policy);
+  }
+  return old;
+}
+
+/*
+ * sys_mkgroup - Create a ticket group funded with base tickets
+ *
+ * Members of the group hold tickets in its currency, so the group as a whole
+ * gets the share of its funding however many processes it contains.
+ *
+ * Parameters:
+ * - name (via argstr): Group name; an existing group of that name is refunded.
+ * - funding (via argint): Base tickets backing the group, at most MAX_FUNDING.
+ * Returns: The group id on success, -1 on invalid arguments or a full table.
+ */
+int sys_mkgroup(void)
+{
+  char *name;
+  int funding, gid;
+
+  if (argstr(0, &name) < 0 || argint(1, &funding) < 0 || funding <= 0)
+  {
+    return -1; // Invalid arguments
+  }
+
+  acquire(&ptable_lock);
+  gid = group_create(name, funding);
+  release(&ptable_lock);
+
+  return gid;
+}
+
+/*
+ * sys_fundgroup - Change the base tickets backing a ticket group
+ *
+ * Parameters:
+ * - gid (via argint): Group id returned by mkgroup.
+ * - funding (via argint): New number of base tickets, at most MAX_FUNDING.
+ * Returns: 0 on success, -1 if the group does not exist or funding is invalid.
+ */
+int sys_fundgroup(void)
+{
+  int gid, funding, r;
+
+  if (argint(0, &gid) < 0 || argint(1, &funding) < 0 || funding <= 0)
+  {
+    return -1; // Invalid arguments
+  }
+
+  acquire(&ptable_lock);
+  r = group_fund(gid, funding);
+  release(&ptable_lock);
+
+  return r;
+}
+
+/*
+ * sys_joingroup - Move a process into a ticket group
+ *
+ * The process keeps its ticket count, now valued in the group's currency.
+ * Children forked afterwards inherit the group.
+ *
+ * Parameters:
+ * - pid (via argint): Process ID to move.
+ * - gid (via argint): Group id, or -1 to hold base tickets again.
+ * Returns: 0 on success, -1 if the PID or group is not found.
+ */
+int sys_joingroup(void)
+{
+  int pid, gid;
+  struct proc *p;
+
+  if (argint(0, &pid) < 0 || argint(1, &gid) < 0)
+  {
+    return -1; // Invalid arguments
+  }
+
+  acquire(&ptable_lock);
+  for (p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->pid == pid && p->state != UNUSED && p->state != ZOMBIE)
+    {
+      int r = group_join(p, gid);
+      release(&ptable_lock);
+      return r;
+    }
+  }
+  release(&ptable_lock);
+
+  return -1; // PID not found
+}
+
+/*
+ * sys_seedrand - Reseed the per-CPU random number generators
+ *
+ * Makes lottery draws reproducible across benchmark runs.
+ *
+ * Parameters:
+ * - seed (via argint): Seed shared by all CPUs (each derives its own state).
+ * Returns: 0 on success, -1 on an invalid argument.
+ */
+int sys_seedrand(void)
+{
+  int seed;
+
+  if (argint(0, &seed) < 0)
+  {
+    return -1; // Invalid argument
+  }
+
+  srand(seed); // Each CPU reseeds itself before its next draw
+
+  return 0;
+}
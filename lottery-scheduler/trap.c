@@ -30,6 +30,17 @@ void idtinit(void)
   lidt(idt, sizeof(idt));
 }
 
+// Track the length of a timer tick in TSC cycles on this CPU
+// Used to turn a process's run time into a fraction of its quantum
+static void tick_measure(void)
+{
+  struct cpu *c = mycpu();
+  uint now = rdtsc();
+  if (c->last_tick_tsc)
+    c->tick_tsc = now - c->last_tick_tsc;
+  c->last_tick_tsc = now;
+}
+
 // PAGEBREAK: 41
 void trap(struct trapframe *tf)
 {
@@ -47,13 +58,23 @@ void trap(struct trapframe *tf)
   switch (tf->trapno)
   {
   case T_IRQ0 + IRQ_TIMER:
+    tick_measure();
     if (cpuid() == 0)
     {
+      uint now;
       acquire(&tickslock);
-      ticks++;
+      now = ++ticks;
       wakeup(&ticks);
       release(&tickslock);
+      if (now % BALANCE_INTERVAL == 0)
+        balance();
     }
+    if (mycpu()->idle)
+      mycpu()->idle_ticks++;
+    lapiceoi();
+    break;
+  case T_IRQ0 + IRQ_WAKEUP:
+    // Work was queued for this idle CPU; the scheduler loop finds it
     lapiceoi();
     break;
   case T_IRQ0 + IRQ_IDE:
@@ -105,7 +126,7 @@ void trap(struct trapframe *tf)
   // If interrupts were on while locks held, would need to check nlock.
   if (myproc() && myproc()->state == RUNNING &&
       tf->trapno == T_IRQ0 + IRQ_TIMER)
-    yield();
+    preempt();
 
   // Check if the process has been killed since we yielded
   if (myproc() && myproc()->killed && (tf->cs & 3) == DPL_USER)
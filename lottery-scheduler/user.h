@@ -31,10 +31,34 @@ struct pinfo
     int pid;
     int tickets;
     int ticks_scheduled;
+    int migrations;
+};
+struct cpuinfo
+{
+    int cpu;
+    int queued;
+    int tickets;
+    int migrations_in;
+    int migrations_out;
 };
 int getpinfo(struct pinfo *);
 int yield(void);
 int settickets_pid(int pid, int tickets);
+int getcpuinfo(struct cpuinfo *);
+int setlotterymode(int mode);
+int setrqpolicy(int cpu, int policy);
+int mkgroup(char *name, int funding);
+int fundgroup(int gid, int funding);
+int joingroup(int pid, int gid);
+int seedrand(int seed);
+
+// lottery modes for setlotterymode
+#define LOTTERY_PERCPU 0 // each CPU draws from its own runqueue
+#define LOTTERY_GLOBAL 1 // each CPU draws from the tickets of all runqueues
+
+// runqueue policies for setrqpolicy
+#define RQ_LOTTERY 0 // random winner weighted by tickets
+#define RQ_STRIDE 1  // deterministic stride scheduling on tickets
 
 // ulib.c
 int stat(const char *, struct stat *);
@@ -107,6 +107,14 @@ sti(void)
   asm volatile("sti");
 }
 
+// Enable interrupts and halt until the next one.  sti takes effect
+// after the following instruction, so no interrupt slips in between.
+static inline void
+sti_hlt(void)
+{
+  asm volatile("sti; hlt");
+}
+
 static inline uint
 xchg(volatile uint *addr, uint newval)
 {
@@ -117,6 +125,25 @@ xchg(volatile uint *addr, uint newval)
   return result;
 }
 
+// Low 32 bits of the time-stamp counter; enough for sub-tick intervals
+static inline uint
+rdtsc(void)
+{
+  uint lo, hi;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return lo;
+}
+
+// 64-by-32-bit division, for quotients known to fit in 32 bits
+// (divl faults otherwise); the kernel has no libgcc for __udivdi3.
+static inline uint
+divl(uint64 n, uint d)
+{
+  uint q, r;
+  asm("divl %4" : "=a"(q), "=d"(r) : "a"((uint)n), "d"((uint)(n >> 32)), "rm"(d));
+  return q;
+}
+
 static inline uint
 rcr2(void)
 {
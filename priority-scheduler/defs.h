@@ -5,6 +5,7 @@ struct inode;
 struct pipe;
 struct proc;
 struct rtcdate;
+struct runqueue;
 struct spinlock;
 struct sleeplock;
 struct stat;
@@ -81,6 +82,7 @@ int lapicid(void);
 extern volatile uint *lapic;
 void lapiceoi(void);
 void lapicinit(void);
+void lapicipi(uchar, int);
 void lapicstartap(uchar, uint);
 void microdelay(int);
 
@@ -115,6 +117,7 @@ struct cpu *mycpu(void);
 struct proc *myproc();
 void pinit(void);
 void procdump(void);
+void kick_idle(struct runqueue *);
 void scheduler(void) __attribute__((noreturn));
 void sched(void);
 void setproc(struct proc *);
@@ -123,6 +126,15 @@ void userinit(void);
 int wait(void);
 void wakeup(void *);
 void yield(void);
+int resched_pending(void);
+void update_priorities(void);
+int setpriority(int, int);
+int charge_tick(struct proc *);
+void mlfq_boost(void);
+void pi_block(struct sleeplock *);
+void pi_acquired(struct sleeplock *);
+void pi_release(struct sleeplock *);
+int setschedmode(int);
 int sys_settickets_pid(void);
 
 // swtch.S
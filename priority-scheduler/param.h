@@ -11,3 +11,9 @@
 #define LOGSIZE (MAXOPBLOCKS * 3) // max data blocks in on-disk log
 #define NBUF (MAXOPBLOCKS * 3)    // size of disk block cache
 #define FSSIZE 1000               // size of file system in blocks
+#define NPRIO 11                  // number of priority levels (0 highest); up to e.g. 40 or 140
+#define AGE_TICKS 50              // ticks waited at one level before moving up a level
+#define PRIO_SWEEP_INTERVAL 100   // ticks between lifetime/PID sweeps of the process table
+#define SCHED_MODE 0              // scheduling mode at boot: 0 static priority, 1 MLFQ
+#define MLFQ_QUANTUM 1            // ticks in a level-0 MLFQ slice; level n gets (n + 1) times this
+#define MLFQ_BOOST_INTERVAL 100   // ticks between MLFQ boosts of every process to level 0
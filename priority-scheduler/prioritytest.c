@@ -1,7 +1,8 @@
 /*
  * Prioritytest.c: User-level test program for the xv6 priority scheduler.
  * Executes a suite of tests to evaluate scheduler performance under various workloads,
- * including CPU-heavy, I/O-bound, mixed, process creation, short tasks, and starvation scenarios.
+ * including CPU-heavy, I/O-bound, mixed, process creation, short tasks, starvation,
+ * priority inheritance and MLFQ gaming scenarios.
  * Measures execution time and context switches.
  */
 
@@ -18,6 +19,8 @@ int timing_mixed_load(void);
 int timing_process_creation(void);
 int timing_short_tasks(void);
 int timing_starvation_check(void);
+int timing_setpriority_holder(void);
+int timing_mlfq_gamer(void);
 
 // Run a test case multiple times and report total and average execution time.
 void run_test(int (*test)(), char *name, int runs)
@@ -40,10 +43,26 @@ void run_test(int (*test)(), char *name, int runs)
 }
 
 // Main function: execute all test cases with pauses between them.
+// Pass "mlfq" to run the suite under the multi-level feedback queue.
 int main(int argc, char *argv[])
 {
+    int mlfq = argc > 1 && strcmp(argv[1], "mlfq") == 0;
+    int old_mode = SCHED_PRIORITY;
+
+    // Switch scheduling mode if requested
+    if (mlfq && (old_mode = setschedmode(SCHED_MLFQ)) < 0)
+    {
+        printf(1, "setschedmode failed\n");
+        exit();
+    }
+
     // Announce start of tests
-    printf(1, "Starting scheduling tests with priority...\n");
+    printf(1, "Starting scheduling tests with %s...\n", mlfq ? "MLFQ" : "priority");
+
+    // Test 8 goes first, while its processes get PIDs below 100: the kernel
+    // resets higher PIDs to priority 5 every PRIO_SWEEP_INTERVAL ticks
+    run_test(timing_setpriority_holder, "Test 8: setpriority on a lock holder", 1);
+    sleep(5);
 
     // Run each test case with 5 runs, pausing 5 ticks between tests
     run_test(timing_cpu_heavy, "Test 1: CPU-heavy", 5);
@@ -60,6 +79,12 @@ int main(int argc, char *argv[])
     sleep(5);
     run_test(timing_starvation_check, "Test 7: Starvation check", 5);
     sleep(5);
+    run_test(timing_mlfq_gamer, "Test 9: Sleep-before-tick gamer", 1);
+    sleep(5);
+
+    // Restore the previous scheduling mode
+    if (mlfq)
+        setschedmode(old_mode);
 
     // Announce completion
     printf(1, "Tests complete.\n");
@@ -471,4 +496,195 @@ int timing_starvation_check(void)
 
     // Return execution time in ticks (~25-30 ticks)
     return end - start;
-}
\ No newline at end of file
+}
+
+
+// Test 8: Lower the priority of a process while it holds a lock a high-priority
+// process waits for. A low-priority writer keeps the inode lock of a file busy
+// while a priority-0 process stats the file and medium-priority hogs load every
+// CPU; another process keeps setting the writer's priority to 10. The writer
+// must keep the priority lent to it until it releases the lock, or the stats
+// stall behind the hogs until aging lifts the writer, hundreds of ticks later.
+int timing_setpriority_holder(void)
+{
+    int writer, lowerer, pid, hogs = 4, stats = 200, bound = 100, took = -1;
+    int hog_pids[4];
+    int fds[2];
+    static char buf[512];
+    struct stat st;
+
+    printf(1, "Test 8: setpriority on a lock holder (%d stats, %d hogs)\n", stats, hogs);
+    if (pipe(fds) < 0)
+    {
+        printf(1, "pipe failed\n");
+        return -1;
+    }
+    int start_switches = getcontextswitches();
+    int start = uptime();
+
+    writer = fork();
+    if (writer < 0)
+    {
+        printf(1, "fork failed\n");
+        return -1;
+    }
+    if (writer == 0)
+    {
+        // Child: low-priority writer, holding the inode lock during each write
+        close(fds[0]); // Only the stat process reports, so read() sees its exit
+        close(fds[1]);
+        setpriority(getpid(), 9);
+        int fd = open("pitest", O_CREATE | O_RDWR);
+        for (;;)
+        {
+            if (write(fd, buf, sizeof(buf)) != sizeof(buf))
+            {
+                close(fd);
+                fd = open("pitest", O_CREATE | O_RDWR); // Start over when full
+            }
+        }
+    }
+    for (int i = 0; i < hogs; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            // Child: medium-priority CPU hog
+            close(fds[0]);
+            close(fds[1]);
+            setpriority(getpid(), 5);
+            for (;;)
+                ;
+        }
+        hog_pids[i] = pid;
+    }
+
+    lowerer = fork();
+    if (lowerer < 0)
+    {
+        printf(1, "fork failed\n");
+        return -1;
+    }
+    if (lowerer == 0)
+    {
+        // Child: keep lowering the writer, boosted or not
+        close(fds[0]);
+        close(fds[1]);
+        setpriority(getpid(), 0);
+        for (;;)
+        {
+            setpriority(writer, 10);
+            sleep(1);
+        }
+    }
+
+    pid = fork();
+    if (pid < 0)
+    {
+        printf(1, "fork failed\n");
+        return -1;
+    }
+    if (pid == 0)
+    {
+        // Child: high-priority process contending for the writer's inode lock
+        setpriority(getpid(), 0);
+        int t0 = uptime();
+        for (int i = 0; i < stats; i++)
+            stat("pitest", &st);
+        took = uptime() - t0;
+        write(fds[1], &took, sizeof(took));
+        exit();
+    }
+
+    // Only the stat process exits by itself; then stop the rest
+    close(fds[1]);
+    if (read(fds[0], &took, sizeof(took)) != sizeof(took))
+        took = -1;
+    close(fds[0]);
+    wait();
+    kill(writer);
+    kill(lowerer);
+    for (int i = 0; i < hogs; i++)
+        kill(hog_pids[i]);
+    for (int i = 0; i < hogs + 2; i++)
+        wait();
+    unlink("pitest");
+
+    printf(1, "%d stats took %d ticks (bound %d)\n", stats, took, bound);
+    if (pid > 100)
+        printf(1, "Test 8: inconclusive, PIDs above 100 were reset to priority 5\n");
+    else
+        printf(1, "Test 8: %s\n", took >= 0 && took <= bound ? "PASS" : "FAIL");
+
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
+
+
+// Test 9: A process that runs for most of each tick and sleeps across the tick
+// boundary, against CPU hogs. Under MLFQ its run time must still be charged, so
+// it is demoted like the hogs and gets a similar share per process, rather than
+// staying at level 0 because it is never running when the timer fires.
+int timing_mlfq_gamer(void)
+{
+    int pid, hogs = 4, duration = 200;
+
+    printf(1, "Test 9: Sleep-before-tick gamer vs %d hogs (%d ticks)\n", hogs, duration);
+    int start_switches = getcontextswitches();
+    int start = uptime();
+    int end_at = start + duration;
+
+    for (int i = 0; i < hogs + 1; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(1, "fork failed at %d\n", i);
+            return -1;
+        }
+        if (pid == 0)
+        {
+            int work = 0;
+            if (i == 0)
+            {
+                // Gamer: count how much work fits in a tick, then do 90% of
+                // that after each tick and sleep across the next one
+                int t = uptime(), per_tick = 0;
+                while (uptime() == t)
+                    ;
+                t++;
+                while (uptime() == t)
+                    per_tick++;
+                while (uptime() < end_at)
+                {
+                    for (int j = 0; j < per_tick * 9 / 10; j++)
+                        uptime();
+                    work += per_tick * 9 / 10;
+                    sleep(1);
+                }
+                printf(1, "gamer: %d work\n", work);
+            }
+            else
+            {
+                while (uptime() < end_at)
+                    work++;
+                printf(1, "hog: %d work\n", work);
+            }
+            exit();
+        }
+    }
+    for (int i = 0; i < hogs + 1; i++)
+        wait();
+
+    int end = uptime();
+    int end_switches = getcontextswitches();
+    printf(1, "Context switches during test: %d\n", end_switches - start_switches);
+    return end - start;
+}
@@ -2,6 +2,16 @@
  * proc.c: Implements process management for the xv6 priority scheduler.
  * Manages process creation, termination, scheduling, and priority updates.
  * Maintains a per-CPU runqueue and tracks context switches and scheduling logs.
+ *
+ * In SCHED_MLFQ mode the same queues form a multi-level feedback queue: new
+ * processes start at level 0, a process that uses its level's quantum (longer
+ * at lower levels) drops one level, time used is not forgotten across sleeps,
+ * and every process is periodically boosted back to level 0.
+ *
+ * Priorities are enforced across CPUs: a task that becomes runnable behind
+ * equal or better work is pushed to the CPU running the least important task
+ * (with a reschedule IPI), and a CPU about to pick pulls a better task that is
+ * waiting behind running work elsewhere.
  */
 
 #include "types.h"
@@ -12,7 +22,9 @@
 #include "x86.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "sleeplock.h"
 #include "runqueue.h"
+#include "traps.h"
 
 // Global process table and lock
 struct proc ptable[NPROC];
@@ -27,6 +39,9 @@ int nextpid = 1;
 // Context switch counter
 int context_switches = 0;
 
+// Current scheduling mode (SCHED_PRIORITY or SCHED_MLFQ)
+int sched_mode = SCHED_MODE;
+
 // Scheduling log structure and index
 #define LOG_SIZE 100
 struct
@@ -79,9 +94,97 @@ void pinit(void)
   // Initialize process table lock
   initlock(&ptable_lock, "ptable");
 
-  // Initialize runqueue for each CPU
+  // Initialize runqueue for each CPU; no CPU is running anything yet
   for (int i = 0; i < ncpu; i++)
+  {
     rq_init(&cpus[i].rq);
+    cpus[i].curr_prio = NPRIO;
+    cpus[i].need_resched = 0;
+  }
+}
+
+// Queue a runnable process. If its CPU is already running equal or more
+// important work, push it to the CPU running the least important task instead.
+// If the process outranks what the target CPU is running, ask that CPU to
+// reschedule: through need_resched, checked on trap return, and for a remote
+// CPU also an IPI so it traps right away rather than at its next tick.
+// Caller must hold ptable_lock.
+static void enqueue(struct proc *p)
+{
+  int target = p->cpu;
+
+  if (p->cpu < 0 || p->cpu >= ncpu)
+    panic("enqueue: invalid CPU assignment");
+
+  // A yielding process whose CPU has nothing better queued runs again here
+  int busy = cpus[target].curr_prio <= p->priority;
+  if (p == myproc() && rq_best(&cpus[target].rq) > p->priority)
+    busy = 0;
+
+  // Find the CPU running the lowest priority (idle CPUs report NPRIO)
+  if (busy)
+  {
+    int worst = p->priority;
+    for (int i = 0; i < ncpu; i++)
+    {
+      if (cpus[i].curr_prio > worst)
+      {
+        worst = cpus[i].curr_prio;
+        target = i;
+      }
+    }
+  }
+
+  p->cpu = target;
+  rq_add(&cpus[target].rq, p);
+
+  // Preempt a CPU running less important work; rq_add wakes a halted idle CPU
+  struct cpu *c = &cpus[target];
+  if (c->curr_prio != NPRIO && c->curr_prio > p->priority)
+  {
+    c->need_resched = 1;
+    if (c != mycpu())
+      lapicipi(c->apicid, T_IRQ0 + IRQ_RESCHED);
+  }
+}
+
+// Find the CPU holding the most important task that is waiting behind running
+// work and outranks everything queued on c. Lockless, so only a hint.
+static struct cpu *pull_source(struct cpu *c, int *prio)
+{
+  struct cpu *src = 0;
+  int best = rq_best(&c->rq);
+
+  for (struct cpu *o = cpus; o < &cpus[ncpu]; o++)
+  {
+    if (o == c || o->rq.count == 0)
+      continue;
+    int b = rq_best(&o->rq);
+    if (b < best && b >= o->curr_prio)
+    {
+      best = b;
+      src = o;
+    }
+  }
+
+  *prio = best;
+  return src;
+}
+
+// Pull a better waiting task from another CPU onto c. Caller must hold ptable_lock.
+static void pull(struct cpu *c)
+{
+  int prio;
+  struct cpu *src = pull_source(c, &prio);
+  if (!src)
+    return;
+
+  struct proc *p = rq_take(&src->rq, prio);
+  if (!p)
+    return;
+
+  p->cpu = c - cpus;
+  rq_add(&c->rq, p);
 }
 
 // Return the ID of the current CPU.
@@ -123,6 +226,18 @@ struct proc *myproc(void)
   return p;
 }
 
+// Whether a more important process was queued for this CPU since the
+// current one was scheduled.
+int resched_pending(void)
+{
+  int r;
+
+  pushcli();
+  r = mycpu()->need_resched;
+  popcli();
+  return r;
+}
+
 // Allocate a new process structure from the process table.
 static struct proc *allocproc(void)
 {
@@ -141,8 +256,14 @@ static struct proc *allocproc(void)
       p->state = EMBRYO;
       p->pid = nextpid++;
       p->priority = 5; // Default priority
-      p->wait_ticks = 0;
+      p->age_tick = 0;
+      p->mlfq_used = 0;
+      p->pi_saved = -1;
+      p->blocked_on = 0;
+      p->held_locks = 0;
       p->next = 0;
+      p->prev = 0;
+      p->rq_level = -1;
       p->creation_time = ticks;
       p->completion_time = 0;
       p->waiting_time = 0;
@@ -298,11 +419,15 @@ int fork(void)
     release(&cpus[i].rq.lock);
   }
 
+  // New processes enter the MLFQ at the top level
+  if (sched_mode == SCHED_MLFQ)
+    np->priority = 0;
+
   // Make process runnable
   np->state = RUNNABLE;
   np->cpu = target_cpu;
   np->last_runnable_tick = ticks;
-  rq_add(&cpus[target_cpu].rq, np);
+  enqueue(np);
   release(&ptable_lock);
 
   return pid;
@@ -420,7 +545,9 @@ int wait(void)
   }
 }
 
-// Update process priorities based on aging and lifetime.
+// Enforce process lifetime and the high-PID priority reset.
+// Runs from CPU 0's timer every PRIO_SWEEP_INTERVAL ticks; aging is done
+// per CPU by rq_age() so the scheduler loop never walks the process table.
 void update_priorities(void)
 {
   // Acquire process table lock
@@ -439,15 +566,13 @@ void update_priorities(void)
         {
           p->state = RUNNABLE;
           p->last_runnable_tick = ticks;
-          if (p->cpu < 0 || p->cpu >= ncpu)
-            panic("update_priorities: invalid CPU assignment");
-          rq_add(&cpus[p->cpu].rq, p);
+          enqueue(p);
         }
         continue;
       }
 
-      // Reset high-PID processes to priority 5
-      if (p->pid > 100 && p->priority != 5)
+      // Reset high-PID processes to priority 5 (MLFQ sets levels itself)
+      if (sched_mode == SCHED_PRIORITY && p->pid > 100 && p->priority != 5 && p->pi_saved < 0)
       {
         if (p->state == RUNNABLE)
           rq_remove(&cpus[p->cpu].rq, p);
@@ -455,27 +580,287 @@ void update_priorities(void)
         if (p->state == RUNNABLE)
           rq_add(&cpus[p->cpu].rq, p);
       }
+    }
+  }
 
-      // Increment waiting time
-      p->wait_ticks++;
+  release(&ptable_lock);
+}
+
+// Length in ticks of an MLFQ time slice at a level.
+static uint mlfq_quantum(int level)
+{
+  return (level + 1) * MLFQ_QUANTUM;
+}
+
+// Add the TSC time p has run since run_start to its MLFQ usage.
+static void mlfq_charge(struct proc *p)
+{
+  uint now = rdtsc();
+  p->mlfq_used += now - p->run_start;
+  p->run_start = now;
+}
+
+// Whether p has used its level's quantum. Nothing expires until this CPU has
+// timed a tick.
+static int mlfq_expired(struct proc *p)
+{
+  uint tick = mycpu()->tick_tsc;
+  return tick && p->mlfq_used >= mlfq_quantum(p->priority) * tick;
+}
 
-      // Age processes: increase priority after 50 ticks
-      if (p->wait_ticks >= 50)
+// Drop p one level and start its allotment there. A process boosted by
+// sleeplock waiters keeps the boost; its own level drops.
+static void mlfq_demote(struct proc *p)
+{
+  p->mlfq_used = 0;
+  int *level = p->pi_saved >= 0 ? &p->pi_saved : &p->priority;
+  if (*level < NPRIO - 1)
+    (*level)++;
+}
+
+// Charge the running process for a timer tick; returns whether it should yield.
+// In MLFQ mode a process keeps the CPU until it has used its level's quantum
+// and then drops one level. Usage is the process's TSC run time, charged here
+// and whenever it leaves the CPU (see scheduler()), so sleeping or yielding
+// just before each tick does not escape it.
+int charge_tick(struct proc *p)
+{
+  if (sched_mode != SCHED_MLFQ)
+    return 1;
+
+  mlfq_charge(p);
+  if (!mlfq_expired(p))
+    return 0;
+
+  // Quantum used up: demote (p is running, so it is on no runqueue)
+  mlfq_demote(p);
+  return 1;
+}
+
+// Move every process back to MLFQ level 0 so demoted processes cannot starve.
+void mlfq_boost(void)
+{
+  acquire(&ptable_lock);
+
+  for (struct proc *p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->state == UNUSED || p->state == ZOMBIE)
+      continue;
+
+    if (p->state == RUNNABLE)
+      rq_remove(&cpus[p->cpu].rq, p);
+    p->priority = 0;
+    p->mlfq_used = 0;
+    if (p->pi_saved >= 0)
+      p->pi_saved = 0;
+    if (p->state == RUNNABLE)
+      rq_add(&cpus[p->cpu].rq, p);
+  }
+
+  release(&ptable_lock);
+}
+
+// Priority inheritance for sleeplocks. A process that blocks on a sleeplock
+// lends its priority to the holder, and on through any sleeplock the holder is
+// itself blocked on, so a chain of holders runs at the priority of the most
+// important waiter. On release the holder drops back to its own priority, or
+// to the best priority still lent to it through other locks it holds.
+// The sleeplock holder fields and the pi fields of struct proc are protected
+// by ptable_lock; the callers in sleeplock.c also hold the sleeplock's spinlock.
+
+// Change the priority of p, requeueing it if it is waiting to run and
+// publishing it if it is running. A running process that no longer outranks
+// what is queued on its CPU is preempted the way enqueue() preempts, instead of
+// at its next tick. Caller must hold ptable_lock.
+static void set_priority(struct proc *p, int prio)
+{
+  if (p->state == RUNNABLE)
+  {
+    rq_remove(&cpus[p->cpu].rq, p);
+    p->priority = prio;
+    enqueue(p);
+  }
+  else
+  {
+    p->priority = prio;
+    if (p->state == RUNNING)
+    {
+      struct cpu *c = &cpus[p->cpu];
+      c->curr_prio = prio;
+      if (rq_best(&c->rq) < prio)
       {
-        if (p->priority > 0 && p->pid <= 100)
-        {
-          if (p->state == RUNNABLE)
-            rq_remove(&cpus[p->cpu].rq, p);
-          p->priority--;
-          if (p->state == RUNNABLE)
-            rq_add(&cpus[p->cpu].rq, p);
-        }
-        p->wait_ticks = 0;
+        c->need_resched = 1;
+        if (c != mycpu())
+          lapicipi(c->apicid, T_IRQ0 + IRQ_RESCHED);
       }
     }
   }
+}
+
+// The priority p runs at given its own priority own: own, or the best priority
+// still lent to it through the locks it holds. Caller must hold ptable_lock.
+static int pi_effective(struct proc *p, int own)
+{
+  int prio = own;
+  for (struct sleeplock *l = p->held_locks; l; l = l->next_held)
+    if (l->waiter_prio < prio)
+      prio = l->waiter_prio;
+  return prio;
+}
+
+// Set the priority of process pid (0 highest) for setpriority(). Returns 0, or
+// -1 if there is no such process. While waiters lend p a better priority, prio
+// only becomes the priority p returns to, in pi_saved, when they stop.
+int setpriority(int pid, int prio)
+{
+  acquire(&ptable_lock);
+  for (struct proc *p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->pid == pid && p->state != UNUSED && p->state != ZOMBIE)
+    {
+      int eff = pi_effective(p, prio);
+      p->pi_saved = eff < prio ? prio : -1;
+      set_priority(p, eff);
+      release(&ptable_lock);
+      return 0;
+    }
+  }
+  release(&ptable_lock);
+  return -1;
+}
+
+// The current process is about to sleep waiting for lk: boost the chain of holders.
+void pi_block(struct sleeplock *lk)
+{
+  struct proc *p = myproc();
+  int prio = p->priority;
+
+  acquire(&ptable_lock);
+  p->blocked_on = lk;
+
+  // Bounded walk, so a deadlock cycle cannot hang us here
+  for (int depth = 0; lk && depth < NPROC; depth++)
+  {
+    struct proc *holder = lk->holder;
+
+    if (prio < lk->waiter_prio)
+      lk->waiter_prio = prio;
+    if (holder == 0 || holder->priority <= prio)
+      break;
+    if (holder->pi_saved < 0)
+      holder->pi_saved = holder->priority;
+    set_priority(holder, prio);
+    lk = holder->blocked_on;
+  }
+
+  release(&ptable_lock);
+}
+
+// The current process now holds lk. Waiters that are still asleep lend
+// their priority again when they wake and find the lock taken.
+void pi_acquired(struct sleeplock *lk)
+{
+  struct proc *p = myproc();
+
+  acquire(&ptable_lock);
+  p->blocked_on = 0;
+  lk->holder = p;
+  lk->waiter_prio = NPRIO;
+  lk->next_held = p->held_locks;
+  p->held_locks = lk;
+  release(&ptable_lock);
+}
+
+// lk is being released: stop lending priority through it.
+void pi_release(struct sleeplock *lk)
+{
+  struct proc *p = lk->holder;
+
+  acquire(&ptable_lock);
+  if (p)
+  {
+    for (struct sleeplock **l = &p->held_locks; *l; l = &(*l)->next_held)
+    {
+      if (*l == lk)
+      {
+        *l = lk->next_held;
+        break;
+      }
+    }
+    lk->holder = 0;
+    lk->waiter_prio = NPRIO;
+    lk->next_held = 0;
+
+    if (p->pi_saved >= 0)
+    {
+      int prio = pi_effective(p, p->pi_saved);
+      if (prio == p->pi_saved)
+        p->pi_saved = -1;
+      set_priority(p, prio);
+    }
+  }
+  release(&ptable_lock);
+}
+
+// Switch scheduling mode, requeueing runnable processes for the new queue layout.
+// Returns the previous mode.
+int setschedmode(int mode)
+{
+  int old;
+
+  acquire(&ptable_lock);
+  old = sched_mode;
+
+  // Take runnable processes off their queues before the layout changes
+  for (struct proc *p = ptable; p < &ptable[NPROC]; p++)
+    if (p->state == RUNNABLE)
+      rq_remove(&cpus[p->cpu].rq, p);
+
+  sched_mode = mode;
+
+  for (struct proc *p = ptable; p < &ptable[NPROC]; p++)
+  {
+    if (p->state == UNUSED || p->state == ZOMBIE)
+      continue;
+    p->mlfq_used = 0;
+    if (p->state == RUNNABLE)
+      rq_add(&cpus[p->cpu].rq, p);
+  }
 
   release(&ptable_lock);
+  return old;
+}
+
+// Halt this CPU until the next interrupt: its timer tick, or the IPI
+// kick_idle() sends when work is queued here. idle is set before the last
+// look at the runqueue, so a CPU queueing work here either sees idle set or
+// has its work seen.
+static void idle(struct cpu *c)
+{
+  cli();
+  xchg(&c->idle, 1);
+  if (c->rq.count == 0)
+    sti_hlt();
+  else
+    sti();
+  c->idle = 0;
+}
+
+// rq has just gone from empty to non-empty: wake its CPU if it is halted
+// in idle(). Called with rq->lock held.
+void kick_idle(struct runqueue *rq)
+{
+  __sync_synchronize(); // Order the queue update before reading idle
+  for (struct cpu *c = cpus; c < &cpus[ncpu]; c++)
+  {
+    if (c == mycpu() || !c->idle)
+      continue;
+    if (&c->rq == rq)
+    {
+      lapicipi(c->apicid, T_IRQ0 + IRQ_RESCHED);
+      break;
+    }
+  }
 }
 
 // Schedule processes on the current CPU.
@@ -489,12 +874,21 @@ void scheduler(void)
     // Disable interrupts
     cli();
 
-    // Update process priorities
-    update_priorities();
+    // Nothing queued locally or waiting elsewhere: halt until there is
+    int prio;
+    if (c->rq.count == 0 && !pull_source(c, &prio))
+    {
+      idle(c);
+      continue;
+    }
 
     // Acquire process table lock
     acquire(&ptable_lock);
 
+    // Take over a better task that another CPU cannot run yet
+    if (ncpu > 1)
+      pull(c);
+
     // Select next process from runqueue
     struct proc *p = rq_select(&c->rq);
     if (!p)
@@ -504,8 +898,10 @@ void scheduler(void)
       continue;
     }
 
-    // Set current process
+    // Set current process and publish its priority to other CPUs
     c->proc = p;
+    c->curr_prio = p->priority;
+    c->need_resched = 0;
     switchuvm(p);
     p->state = RUNNING;
 
@@ -522,11 +918,29 @@ void scheduler(void)
     context_switches++;
 
     // Switch to process context
+    p->run_start = rdtsc();
     swtch(&(c->scheduler), p->context);
     switchkvm();
 
+    // Charge the run that just ended, so a process that leaves the CPU
+    // before every tick still uses up its MLFQ allotment
+    if (sched_mode == SCHED_MLFQ)
+    {
+      mlfq_charge(p);
+      if (mlfq_expired(p))
+      {
+        int queued = p->state == RUNNABLE;
+        if (queued)
+          rq_remove(&cpus[p->cpu].rq, p);
+        mlfq_demote(p);
+        if (queued)
+          rq_add(&cpus[p->cpu].rq, p);
+      }
+    }
+
     // Clear current process
     c->proc = 0;
+    c->curr_prio = NPRIO;
     release(&ptable_lock);
 
     // Re-enable interrupts
@@ -552,11 +966,7 @@ void sched(void)
 
   // Re-add runnable process to runqueue
   if (p->state == RUNNABLE)
-  {
-    if (p->cpu < 0 || p->cpu >= ncpu)
-      panic("sched: invalid CPU assignment");
-    rq_add(&cpus[p->cpu].rq, p);
-  }
+    enqueue(p);
 
   // Switch to scheduler context
   intena = mycpu()->intena;
@@ -650,19 +1060,12 @@ static void wakeup1(void *chan)
       p->state = RUNNABLE;
       p->last_runnable_tick = ticks;
 
-      // Adjust priority for certain conditions
-      if (p->priority > 0 && p->priority != 5)
-      {
-        rq_remove(&cpus[p->cpu].rq, p);
+      // Adjust priority for certain conditions (not queued yet, so just set it).
+      // MLFQ has no wakeup boost: sleeping just before the quantum ends must not pay.
+      if (sched_mode == SCHED_PRIORITY && p->priority > 0 && p->priority != 5)
         p->priority = 0;
-        rq_add(&cpus[p->cpu].rq, p);
-      }
-
-      // Validate CPU assignment
-      if (p->cpu < 0 || p->cpu >= ncpu)
-        panic("wakeup1: invalid CPU assignment");
 
-      rq_add(&cpus[p->cpu].rq, p);
+      enqueue(p);
     }
   }
 }
@@ -695,9 +1098,7 @@ int kill(int pid)
         // Make sleeping process runnable
         p->state = RUNNABLE;
         p->last_runnable_tick = ticks;
-        if (p->cpu < 0 || p->cpu >= ncpu)
-          panic("kill: invalid CPU assignment");
-        rq_add(&cpus[p->cpu].rq, p);
+        enqueue(p);
       }
       release(&ptable_lock);
       return 0;
@@ -741,4 +1142,6 @@ void procdump(void)
     }
     cprintf("\n");
   }
+  for (int i = 0; i < ncpu; i++)
+    cprintf("cpu%d: idle %d ticks\n", i, cpus[i].idle_ticks);
 }
\ No newline at end of file
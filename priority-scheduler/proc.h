@@ -20,11 +20,22 @@ struct cpu
   int intena;                // Were interrupts enabled before pushcli?
   struct proc *proc;         // The currently running process on this CPU
   struct runqueue rq;        // Per-CPU runqueue for priority scheduling
+  volatile int curr_prio;    // Priority of the running process (NPRIO when idle)
+  volatile int need_resched; // A more important process was queued; yield on trap return
+  volatile uint idle;        // Halted in the idle loop
+  uint idle_ticks;           // Timer ticks spent idle
+  uint last_tick_tsc;        // TSC at the previous timer interrupt
+  uint tick_tsc;             // TSC cycles in a timer tick (0 until measured)
 };
 
 extern struct cpu cpus[NCPU];
 extern int ncpu;
 
+// Scheduling modes
+#define SCHED_PRIORITY 0 // Static priorities with aging and a wakeup boost
+#define SCHED_MLFQ 1     // Multi-level feedback queue with per-level quanta
+extern int sched_mode;
+
 // Context structure for saving registers during a context switch
 struct context
 {
@@ -62,9 +73,16 @@ struct proc
   struct file *ofile[NOFILE]; // Open files
   struct inode *cwd;          // Current directory
   char name[16];              // Process name (for debugging)
-  int priority;               // Priority level (0-10, 0 is highest)
+  int priority;               // Priority level (0 to NPRIO-1, 0 is highest)
   struct proc *next;          // Next process in priority queue
-  int wait_ticks;             // Track waiting time for aging
+  struct proc *prev;          // Previous process in priority queue
+  int rq_level;               // Runqueue level the process is linked into (-1 if none)
+  uint age_tick;              // Tick the process joined its current queue level, for aging
+  uint mlfq_used;             // TSC cycles run at the current MLFQ level, kept across sleeps
+  uint run_start;             // TSC when run time was last charged to mlfq_used
+  int pi_saved;               // Own priority while boosted by sleeplock waiters (-1 if not)
+  struct sleeplock *blocked_on; // Sleeplock the process is waiting for, or 0
+  struct sleeplock *held_locks; // Sleeplocks the process holds, linked by next_held
   uint creation_time;         // Time when process was created
   uint completion_time;       // Time when process completed
   uint waiting_time;          // Total time spent in RUNNABLE state
@@ -1,15 +1,73 @@
 /*
  * runqueue.c: Manages per-CPU runqueues for the priority scheduler.
  * Provides functions to initialize, add, remove, and select processes from runqueues,
- * organizing processes by priority (0-10, 0 highest) and a special queue for priority 5.
+ * organizing processes by priority (0 to NPRIO-1, 0 highest) and a special queue for priority 5.
+ *
+ * Each level is an intrusive doubly linked list (prev/next in struct proc), so removal
+ * is O(1), and a bitmap of non-empty levels lets selection find the highest priority
+ * with a find-first-set per word instead of scanning every level.
+ *
+ * Every queue is FIFO and stamped on entry (age_tick), so each list is ordered
+ * by how long its processes have waited; aging only needs to look at the heads.
  */
 
 #include "types.h"
 #include "defs.h"
+#include "x86.h"
 #include "proc.h"
 #include "runqueue.h"
 
-// Initialize a runqueue, setting up its lock and priority queues.
+// Map a priority to its queue index; priority 5 uses the short-lived queue
+// except in MLFQ mode, where every level is an ordinary queue.
+static int rq_level_of(int priority)
+{
+    return (priority == 5 && sched_mode == SCHED_PRIORITY) ? RQ_SHORT : priority;
+}
+
+// Append a process to the tail of queue level and mark the level non-empty.
+static void rq_link(struct runqueue *rq, struct proc *p, int level)
+{
+    p->age_tick = ticks;
+    p->next = 0;
+    p->prev = rq->priority_tail[level];
+    if (p->prev)
+        p->prev->next = p;
+    else
+        rq->priority_head[level] = p;
+    rq->priority_tail[level] = p;
+    p->rq_level = level;
+
+    // The short-lived queue is checked on its own and has no bit
+    if (level < NPRIO)
+        rq->bitmap[level / 32] |= 1u << (level % 32);
+
+    rq->count++;
+}
+
+// Unlink a process from the queue it is on, clearing the level's bit once it empties.
+static void rq_unlink(struct runqueue *rq, struct proc *p)
+{
+    int level = p->rq_level;
+
+    if (p->prev)
+        p->prev->next = p->next;
+    else
+        rq->priority_head[level] = p->next;
+    if (p->next)
+        p->next->prev = p->prev;
+    else
+        rq->priority_tail[level] = p->prev;
+
+    if (level < NPRIO && rq->priority_head[level] == 0)
+        rq->bitmap[level / 32] &= ~(1u << (level % 32));
+
+    p->next = 0;
+    p->prev = 0;
+    p->rq_level = -1;
+    rq->count--;
+}
+
+// Initialize a runqueue, setting up its lock, priority queues and bitmap.
 void rq_init(struct runqueue *rq)
 {
     // Initialize the spinlock for thread-safe runqueue access
@@ -18,16 +76,16 @@ void rq_init(struct runqueue *rq)
     // Reset process count
     rq->count = 0;
 
-    // Clear priority queues (0-10) for all priority levels
-    for (int i = 0; i < 11; i++)
+    // Clear priority queues for all levels and the short-lived queue
+    for (int i = 0; i <= NPRIO; i++)
     {
         rq->priority_head[i] = 0;
         rq->priority_tail[i] = 0;
     }
 
-    // Clear special queue for short-lived processes (priority 5)
-    rq->short_lived_head = 0;
-    rq->short_lived_tail = 0;
+    // No level is occupied yet
+    for (int i = 0; i < RQ_BITMAP_WORDS; i++)
+        rq->bitmap[i] = 0;
 }
 
 // Add a process to the runqueue based on its priority.
@@ -38,63 +96,30 @@ void rq_add(struct runqueue *rq, struct proc *p)
 
     // Check if runqueue is full
     if (rq->count >= MAX_PROCS)
-        panic("runqueue full");
+        panic("rq_add: runqueue full");
 
     // Validate process pointer
     if (!p)
         panic("rq_add: null proc");
 
-    // Handle special case: priority 5 processes go to short-lived queue
-    if (p->priority == 5)
-    {
-        p->next = 0; // Clear next pointer
-        if (rq->short_lived_head == 0)
-        {
-            // Empty queue: set process as both head and tail
-            rq->short_lived_head = p;
-            rq->short_lived_tail = p;
-        }
-        else
-        {
-            // Non-empty queue: append to tail
-            if (!rq->short_lived_tail)
-                panic("rq_add: null short_lived_tail");
-            rq->short_lived_tail->next = p;
-            rq->short_lived_tail = p;
-        }
-    }
-    else
-    {
-        // Handle other priorities (0-4, 6-10)
-        int prio = p->priority;
-        if (prio < 0 || prio > 10)
-            panic("rq_add: invalid priority");
+    // A process may only be linked into one queue at a time
+    if (p->rq_level >= 0)
+        panic("rq_add: already queued");
 
-        p->next = 0; // Clear next pointer
-        if (rq->priority_head[prio] == 0)
-        {
-            // Empty queue for this priority: set as head and tail
-            rq->priority_head[prio] = p;
-            rq->priority_tail[prio] = p;
-        }
-        else
-        {
-            // Non-empty queue: append to tail
-            if (!rq->priority_tail[prio])
-                panic("rq_add: null priority_tail");
-            rq->priority_tail[prio]->next = p;
-            rq->priority_tail[prio] = p;
-        }
-    }
+    // Validate priority; priority 5 processes go to the short-lived queue
+    if (p->priority < 0 || p->priority >= NPRIO)
+        panic("rq_add: invalid priority");
+    rq_link(rq, p, rq_level_of(p->priority));
 
-    // Increment process count
-    rq->count++;
+    // An empty queue's CPU may be halted in idle()
+    if (rq->count == 1)
+        kick_idle(rq);
 
     // Release runqueue lock
     release(&rq->lock);
 }
 
-// Remove a process from the runqueue.
+// Remove a process from the runqueue; does nothing if it is not queued.
 void rq_remove(struct runqueue *rq, struct proc *p)
 {
     // Acquire runqueue lock for thread safety
@@ -104,120 +129,132 @@ void rq_remove(struct runqueue *rq, struct proc *p)
     if (!p)
         panic("rq_remove: null proc");
 
-    // Handle priority 5 processes in short-lived queue
-    if (p->priority == 5)
-    {
-        struct proc *curr = rq->short_lived_head;
-        struct proc *prev = 0;
+    // The process records its own queue, so no traversal is needed
+    if (p->rq_level >= 0)
+        rq_unlink(rq, p);
 
-        // Traverse queue to find process
-        while (curr != 0)
-        {
-            if (curr == p)
-            {
-                // Update links to remove process
-                if (prev == 0)
-                    rq->short_lived_head = curr->next;
-                else
-                    prev->next = curr->next;
-
-                // Update tail if removing last process
-                if (curr->next == 0)
-                    rq->short_lived_tail = prev;
-
-                p->next = 0; // Clear next pointer
-                rq->count--; // Decrement count
-                break;
-            }
-            prev = curr;
-            curr = curr->next;
-        }
+    // Release runqueue lock
+    release(&rq->lock);
+}
+
+// Select and remove the highest-priority process from the runqueue.
+struct proc *rq_select(struct runqueue *rq)
+{
+    struct proc *p = 0;
+
+    // Acquire runqueue lock for thread safety
+    acquire(&rq->lock);
+
+    // Check short-lived queue (priority 5) first
+    if (rq->priority_head[RQ_SHORT])
+    {
+        p = rq->priority_head[RQ_SHORT];
     }
     else
     {
-        // Handle other priorities (0-4, 6-10)
-        int prio = p->priority;
-        if (prio < 0 || prio > 10)
-            panic("rq_remove: invalid priority");
-
-        struct proc *curr = rq->priority_head[prio];
-        struct proc *prev = 0;
-
-        // Traverse queue to find process
-        while (curr != 0)
+        // Lowest set bit is the highest non-empty priority
+        for (int w = 0; w < RQ_BITMAP_WORDS; w++)
         {
-            if (curr == p)
+            if (rq->bitmap[w])
             {
-                // Update links to remove process
-                if (prev == 0)
-                    rq->priority_head[prio] = curr->next;
-                else
-                    prev->next = curr->next;
-
-                // Update tail if removing last process
-                if (curr->next == 0)
-                    rq->priority_tail[prio] = prev;
-
-                p->next = 0; // Clear next pointer
-                rq->count--; // Decrement count
+                p = rq->priority_head[w * 32 + bsf(rq->bitmap[w])];
                 break;
             }
-            prev = curr;
-            curr = curr->next;
         }
     }
 
+    // Remove process from head of its queue
+    if (p)
+        rq_unlink(rq, p);
+
     // Release runqueue lock
     release(&rq->lock);
+    return p;
 }
 
-// Select and remove the highest-priority process from the runqueue.
-struct proc *rq_select(struct runqueue *rq)
+// Move up one priority every process in a queue that has waited AGE_TICKS at its level.
+static void rq_age_level(struct runqueue *rq, int level, uint now)
 {
-    // Acquire runqueue lock for thread safety
-    acquire(&rq->lock);
+    struct proc *p = rq->priority_head[level];
 
-    // Return null if runqueue is empty
-    if (rq->count == 0)
+    // Lists are in entry order, so stop at the first process that is not due
+    while (p && now - p->age_tick >= AGE_TICKS)
     {
-        release(&rq->lock);
-        return 0;
+        struct proc *next = p->next;
+
+        // High-PID processes are held at priority 5 by update_priorities
+        if (p->pid <= 100)
+        {
+            rq_unlink(rq, p);
+            p->priority--;
+            rq_link(rq, p, rq_level_of(p->priority));
+        }
+        p = next;
     }
+}
 
-    // Check short-lived queue (priority 5) first
-    struct proc *p = rq->short_lived_head;
-    if (p)
+// Age the processes waiting on a runqueue; called from each CPU's timer interrupt.
+void rq_age(struct runqueue *rq, uint now)
+{
+    // Acquire runqueue lock for thread safety
+    acquire(&rq->lock);
+
+    // Visit only non-empty levels below 0 (level 0 cannot be raised)
+    for (int w = 0; w < RQ_BITMAP_WORDS; w++)
     {
-        // Remove process from head
-        rq->short_lived_head = p->next;
-        if (!p->next)
-            rq->short_lived_tail = 0;
-
-        p->next = 0; // Clear next pointer
-        rq->count--; // Decrement count
-        release(&rq->lock);
-        return p;
+        uint bits = rq->bitmap[w];
+        if (w == 0)
+            bits &= ~1u;
+        while (bits)
+        {
+            int level = w * 32 + bsf(bits);
+            bits &= bits - 1;
+            rq_age_level(rq, level, now);
+        }
     }
 
-    // Check priority queues (0-10) in ascending order
-    for (int i = 0; i < 11; i++)
+    // The short-lived queue holds priority 5 processes
+    rq_age_level(rq, RQ_SHORT, now);
+
+    // Release runqueue lock
+    release(&rq->lock);
+}
+
+// Return the highest priority queued on a runqueue, or NPRIO if it is empty.
+// Reads the bitmap without the lock, so the answer is only a hint.
+int rq_best(struct runqueue *rq)
+{
+    int best = NPRIO;
+
+    // Lowest set bit is the highest non-empty priority
+    for (int w = 0; w < RQ_BITMAP_WORDS; w++)
     {
-        if (rq->priority_head[i])
+        if (rq->bitmap[w])
         {
-            // Remove process from head
-            p = rq->priority_head[i];
-            rq->priority_head[i] = p->next;
-            if (!p->next)
-                rq->priority_tail[i] = 0;
-
-            p->next = 0; // Clear next pointer
-            rq->count--; // Decrement count
-            release(&rq->lock);
-            return p;
+            best = w * 32 + bsf(rq->bitmap[w]);
+            break;
         }
     }
 
-    // Release lock and return null if no process found
+    // Processes on the short-lived queue have priority 5
+    if (rq->priority_head[RQ_SHORT] && best > 5)
+        best = 5;
+    return best;
+}
+
+// Remove and return the first process queued at a priority, or 0 if there is none.
+struct proc *rq_take(struct runqueue *rq, int priority)
+{
+    struct proc *p;
+
+    // Acquire runqueue lock for thread safety
+    acquire(&rq->lock);
+
+    p = rq->priority_head[rq_level_of(priority)];
+    if (p)
+        rq_unlink(rq, p);
+
+    // Release runqueue lock
     release(&rq->lock);
-    return 0;
-}
\ No newline at end of file
+    return p;
+}
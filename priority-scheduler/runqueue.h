@@ -2,22 +2,31 @@
 #define RUNQUEUE_H
 
 #include "spinlock.h"
+#include "param.h"
 
 #define MAX_PROCS 64
 
+// Queue index of the short-lived FIFO (priority 5), kept after the NPRIO levels
+#define RQ_SHORT NPRIO
+
+// Words needed for one bit per priority level
+#define RQ_BITMAP_WORDS ((NPRIO + 31) / 32)
+
 struct runqueue
 {
-    struct proc *priority_head[11]; // Head of linked list for each priority (0-10)
-    struct proc *priority_tail[11]; // Tail of linked list for each priority
-    struct proc *short_lived_head;  // Head of short-lived FIFO queue
-    struct proc *short_lived_tail;  // Tail of short-lived FIFO queue
-    int count;                      // Total number of processes in runqueue
-    struct spinlock lock;           // Lock for runqueue operations
+    struct proc *priority_head[NPRIO + 1]; // Head of doubly linked list for each priority, plus RQ_SHORT
+    struct proc *priority_tail[NPRIO + 1]; // Tail of doubly linked list for each priority, plus RQ_SHORT
+    uint bitmap[RQ_BITMAP_WORDS];          // Bit i set while priority_head[i] is non-empty
+    int count;                             // Total number of processes in runqueue
+    struct spinlock lock;                  // Lock for runqueue operations
 };
 
 void rq_init(struct runqueue *rq);
 void rq_add(struct runqueue *rq, struct proc *p);
 void rq_remove(struct runqueue *rq, struct proc *p);
 struct proc *rq_select(struct runqueue *rq);
+void rq_age(struct runqueue *rq, uint now);
+int rq_best(struct runqueue *rq);
+struct proc *rq_take(struct runqueue *rq, int priority);
 
-#endif
\ No newline at end of file
+#endif
@@ -17,6 +17,9 @@ initsleeplock(struct sleeplock *lk, char *name)
   lk->name = name;
   lk->locked = 0;
   lk->pid = 0;
+  lk->holder = 0;
+  lk->waiter_prio = NPRIO;
+  lk->next_held = 0;
 }
 
 void
@@ -24,10 +27,13 @@ acquiresleep(struct sleeplock *lk)
 {
   acquire(&lk->lk);
   while (lk->locked) {
+    // Lend our priority to the holder while we wait
+    pi_block(lk);
     sleep(lk, &lk->lk);
   }
   lk->locked = 1;
   lk->pid = myproc()->pid;
+  pi_acquired(lk);
   release(&lk->lk);
 }
 
@@ -35,6 +41,7 @@ void
 releasesleep(struct sleeplock *lk)
 {
   acquire(&lk->lk);
+  pi_release(lk);
   lk->locked = 0;
   lk->pid = 0;
   wakeup(lk);
@@ -2,6 +2,11 @@
 struct sleeplock {
   uint locked;       // Is the lock held?
   struct spinlock lk; // spinlock protecting this sleep lock
+
+  // Priority inheritance (protected by ptable_lock, see proc.c)
+  struct proc *holder;          // Process holding lock
+  int waiter_prio;              // Best priority among waiters, NPRIO if none
+  struct sleeplock *next_held;  // Next lock held by the same process
   
   // For debugging:
   char *name;        // Name of lock.
@@ -103,6 +103,7 @@ extern int sys_yield(void);
 extern int sys_setpriority(void);
 extern int sys_getcontextswitches(void);
 extern int sys_print_sched_log(void);
+extern int sys_setschedmode(void);
 
 static int (*syscalls[])(void) = {
     [SYS_fork] sys_fork,
@@ -130,6 +131,7 @@ static int (*syscalls[])(void) = {
     [SYS_setpriority] sys_setpriority,
     [SYS_getcontextswitches] sys_getcontextswitches,
     [SYS_print_sched_log] sys_print_sched_log,
+    [SYS_setschedmode] sys_setschedmode,
 };
 
 void syscall(void)
@@ -22,4 +22,5 @@
 #define SYS_yield 22
 #define SYS_setpriority 23
 #define SYS_getcontextswitches 24
-#define SYS_print_sched_log 25
\ No newline at end of file
+#define SYS_print_sched_log 25
+#define SYS_setschedmode 26
\ No newline at end of file
@@ -125,38 +125,13 @@ int sys_setpriority(void)
   if (argint(0, &pid) < 0 || argint(1, &priority) < 0)
     return -1;
 
-  // Validate priority range (0-10, 0 highest)
-  if (priority < 0 || priority > 10)
+  // Validate priority range (0 to NPRIO-1, 0 highest)
+  if (priority < 0 || priority >= NPRIO)
     return -1;
 
-  // Acquire process table lock for thread safety
-  acquire(&ptable_lock);
-
-  // Search for process with matching PID
-  struct proc *p;
-  for (p = ptable; p < &ptable[NPROC]; p++)
-  {
-    if (p->pid == pid)
-    {
-      // Update runqueue if process is runnable
-      if (p->state == RUNNABLE)
-        rq_remove(&cpus[p->cpu].rq, p);
-
-      // Set new priority
-      p->priority = priority;
-
-      // Re-add to runqueue if still runnable
-      if (p->state == RUNNABLE)
-        rq_add(&cpus[p->cpu].rq, p);
-
-      release(&ptable_lock);
-      return 0;
-    }
-  }
-
-  // Process not found
-  release(&ptable_lock);
-  return -1;
+  // Requeue through the scheduler so the new priority is pushed to a CPU,
+  // preempts less important work and is published in curr_prio
+  return setpriority(pid, priority);
 }
 
 // Return the total number of context switches.
@@ -170,4 +145,16 @@ int sys_print_sched_log(void)
 {
   print_sched_log();
   return 0;
+}
+
+// Switch between static priority and MLFQ scheduling; returns the previous mode.
+int sys_setschedmode(void)
+{
+  int mode;
+
+  // Fetch and validate mode
+  if (argint(0, &mode) < 0 || (mode != SCHED_PRIORITY && mode != SCHED_MLFQ))
+    return -1;
+
+  return setschedmode(mode);
 }
\ No newline at end of file
@@ -33,6 +33,8 @@ void idtinit(void)
 // PAGEBREAK: 41
 void trap(struct trapframe *tf)
 {
+  uint tsc;
+
   if (tf->trapno == T_SYSCALL)
   {
     if (myproc()->killed)
@@ -41,19 +43,47 @@ void trap(struct trapframe *tf)
     syscall();
     if (myproc()->killed)
       exit();
+    // The system call woke something more important than us
+    if (resched_pending())
+      yield();
     return;
   }
 
   switch (tf->trapno)
   {
   case T_IRQ0 + IRQ_TIMER:
+    // Time the tick in TSC cycles, the unit MLFQ charges run time in
+    tsc = rdtsc();
+    if (mycpu()->last_tick_tsc)
+      mycpu()->tick_tsc = tsc - mycpu()->last_tick_tsc;
+    mycpu()->last_tick_tsc = tsc;
+
     if (cpuid() == 0)
     {
       acquire(&tickslock);
       ticks++;
       wakeup(&ticks);
       release(&tickslock);
+
+      // Lifetime and PID checks need the whole table, so do them rarely
+      if (ticks % PRIO_SWEEP_INTERVAL == 0)
+        update_priorities();
+
+      // MLFQ replaces aging with a periodic boost to the top level
+      if (sched_mode == SCHED_MLFQ && ticks % MLFQ_BOOST_INTERVAL == 0)
+        mlfq_boost();
     }
+
+    // Age processes waiting on this CPU's runqueue
+    if (sched_mode == SCHED_PRIORITY)
+      rq_age(&mycpu()->rq, ticks);
+    if (mycpu()->idle)
+      mycpu()->idle_ticks++;
+    lapiceoi();
+    break;
+  case T_IRQ0 + IRQ_RESCHED:
+    // A higher-priority task was queued here; need_resched is set, the yield below handles it.
+    // Also wakes this CPU from idle() when rq_add queues work for it.
     lapiceoi();
     break;
   case T_IRQ0 + IRQ_IDE:
@@ -103,8 +133,11 @@ void trap(struct trapframe *tf)
 
   // Force process to give up CPU on clock tick.
   // If interrupts were on while locks held, would need to check nlock.
+  // In MLFQ mode only once the process has used its level's quantum.
+  // A wakeup of more important work (here, or by IPI) always preempts.
   if (myproc() && myproc()->state == RUNNING &&
-      tf->trapno == T_IRQ0 + IRQ_TIMER)
+      ((tf->trapno == T_IRQ0 + IRQ_TIMER && charge_tick(myproc())) ||
+       resched_pending()))
     yield();
 
   // Check if the process has been killed since we yielded
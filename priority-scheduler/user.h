@@ -4,6 +4,10 @@
 struct stat;
 struct rtcdate;
 
+// Scheduling modes for setschedmode
+#define SCHED_PRIORITY 0 // static priorities with aging
+#define SCHED_MLFQ 1     // multi-level feedback queue
+
 // system calls
 int fork(void);
 int exit(void) __attribute__((noreturn));
@@ -30,6 +34,7 @@ int yield(void);
 int setpriority(int pid, int priority);
 int getcontextswitches(void);
 void print_sched_log(void);
+int setschedmode(int mode);
 
 // ulib.c
 int stat(const char *, struct stat *);
@@ -107,6 +107,14 @@ sti(void)
   asm volatile("sti");
 }
 
+// Enable interrupts and halt until the next one.  sti takes effect
+// after the following instruction, so no interrupt slips in between.
+static inline void
+sti_hlt(void)
+{
+  asm volatile("sti; hlt");
+}
+
 static inline uint
 xchg(volatile uint *addr, uint newval)
 {
@@ -117,6 +125,24 @@ xchg(volatile uint *addr, uint newval)
   return result;
 }
 
+// Index of the least significant set bit of a non-zero word
+static inline uint
+bsf(uint val)
+{
+  uint idx;
+  asm volatile("bsfl %1,%0" : "=r"(idx) : "rm"(val));
+  return idx;
+}
+
+// Low 32 bits of the time-stamp counter; enough for sub-tick intervals
+static inline uint
+rdtsc(void)
+{
+  uint lo, hi;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return lo;
+}
+
 static inline uint
 rcr2(void)
 {
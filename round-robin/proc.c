@@ -6,6 +6,7 @@
 #include "x86.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "traps.h"
 
 struct ptable ptable;
 static struct proc *initproc;
@@ -18,7 +19,54 @@ static void wakeup1(void *chan);
 
 void pinit(void)
 {
+    int i;
+
     initlock(&ptable.lock, "ptable");
+    for (i = 0; i < ncpu; i++)
+        rq_init(&cpus[i].rq);
+}
+
+// Choose the runqueue for a process that is becoming RUNNABLE:
+// stay on its previous CPU (warm cache) unless that queue is
+// more than one longer than the shortest queue.
+static int
+pick_cpu(struct proc *p)
+{
+    int i, best = 0;
+
+    for (i = 1; i < ncpu; i++)
+        if (cpus[i].rq.count < cpus[best].rq.count)
+            best = i;
+    if (p->cpu >= 0 && p->cpu < ncpu &&
+        cpus[p->cpu].rq.count <= cpus[best].rq.count + 1)
+        return p->cpu;
+    return best;
+}
+
+// Mark p RUNNABLE and queue it on a CPU.
+// The ptable lock must be held.
+static void
+make_runnable(struct proc *p)
+{
+    p->state = RUNNABLE;
+    p->runnable_since = ticks;
+    p->cpu = pick_cpu(p);
+    rq_add(&cpus[p->cpu].rq, p);
+}
+
+// Return the CPU with the longest runqueue other than c,
+// or 0 if no other CPU has anything queued.  Lock-free
+// peek, so the answer is only a hint.
+static struct cpu *
+busiest_cpu(struct cpu *c)
+{
+    struct cpu *o, *victim = 0;
+
+    for (o = cpus; o < &cpus[ncpu]; o++)
+        if (o != c && o->rq.count > 0 &&
+            (victim == 0 || o->rq.count > victim->rq.count))
+            victim = o;
+    return victim;
 }
 
 // Must be called with interrupts disabled
@@ -86,6 +134,8 @@ found:
     p->run_ticks = 0;
     p->wait_ticks = 0;
     p->end_ticks = 0;
+    p->next = 0;
+    p->cpu = -1;
     p->parent = 0;  // Reset parent
     p->name[0] = 0; // Reset name
     p->killed = 0;  // Reset killed
@@ -137,7 +187,7 @@ void userinit(void)
     p->cwd = namei("/");
 
     acquire(&ptable.lock);
-    p->state = RUNNABLE;
+    make_runnable(p);
     release(&ptable.lock);
 }
 
@@ -201,7 +251,7 @@ int fork(void)
     pid = np->pid;
 
     acquire(&ptable.lock);
-    np->state = RUNNABLE;
+    make_runnable(np);
     release(&ptable.lock);
 
     return pid;
@@ -301,6 +351,34 @@ int wait(void)
     }
 }
 
+// Halt this CPU until the next interrupt: its timer tick, or the
+// IPI kick_idle() sends when work is queued here.  idle is set
+// before the last look at the runqueue, so a CPU queueing work
+// here either sees idle set or has its work seen.
+static void
+idle(struct cpu *c)
+{
+    cli();
+    xchg(&c->idle, 1);
+    if (c->rq.count == 0)
+        sti_hlt();
+    else
+        sti();
+    c->idle = 0;
+}
+
+// rq has just gone from empty to non-empty: wake its CPU if it
+// is halted in idle().  Called with rq->lock held.
+void kick_idle(struct runqueue *rq)
+{
+    struct cpu *c;
+
+    __sync_synchronize(); // Order the queue update before reading idle
+    for (c = cpus; c < cpus + ncpu; c++)
+        if (&c->rq == rq && c != mycpu() && c->idle)
+            lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+}
+
 // PAGEBREAK: 42
 //  Per-CPU process scheduler.
 //  Each CPU calls scheduler() after setting itself up.
@@ -309,37 +387,50 @@ int wait(void)
 //   - swtch to start running that process
 //   - eventually that process transfers control
 //       via swtch back to the scheduler.
+//  Each CPU runs its own runqueue in FIFO order and, when
+//  that is empty, steals the oldest process from the CPU
+//  with the longest queue.
 void scheduler(void)
 {
     struct proc *p;
     struct cpu *c = mycpu();
+    struct cpu *victim;
     c->proc = 0;
 
     for (;;)
     {
         sti();
-        acquire(&ptable.lock);
-        for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-        {
-            if (p->state != RUNNABLE)
-                continue;
 
-            for (struct proc *p2 = ptable.proc; p2 < &ptable.proc[NPROC]; p2++)
-            {
-                if (p2->state == RUNNABLE && p2 != p)
-                    p2->wait_ticks++;
-            }
+        // Nothing queued here or elsewhere: halt until there is.
+        if (c->rq.count == 0 && busiest_cpu(c) == 0)
+        {
+            idle(c);
+            continue;
+        }
 
-            c->proc = p;
-            switchuvm(p);
-            if (p->first_run_ticks == 0)
-                p->first_run_ticks = ticks;
-            p->state = RUNNING;
-            context_switches++;
-            swtch(&(c->scheduler), p->context);
-            switchkvm();
-            c->proc = 0;
+        acquire(&ptable.lock);
+        p = rq_select(&c->rq);
+        if (p == 0 && (victim = busiest_cpu(c)) != 0)
+            p = rq_select(&victim->rq);
+        if (p == 0)
+        {
+            release(&ptable.lock);
+            continue;
         }
+        if (p->state != RUNNABLE)
+            panic("scheduler: queued proc not runnable");
+
+        p->cpu = c - cpus;
+        p->wait_ticks += ticks - p->runnable_since;
+        c->proc = p;
+        switchuvm(p);
+        if (p->first_run_ticks == 0)
+            p->first_run_ticks = ticks;
+        p->state = RUNNING;
+        context_switches++;
+        swtch(&(c->scheduler), p->context);
+        switchkvm();
+        c->proc = 0;
         release(&ptable.lock);
     }
 }
@@ -374,7 +465,7 @@ void yield(void)
 {
     struct proc *curproc = myproc();
     acquire(&ptable.lock);
-    curproc->state = RUNNABLE;
+    make_runnable(curproc);
     sched();
     release(&ptable.lock);
 }
@@ -445,7 +536,7 @@ static void wakeup1(void *chan)
     {
         if (p->state == SLEEPING && p->chan == chan)
         {
-            p->state = RUNNABLE;
+            make_runnable(p);
         }
     }
 }
@@ -472,7 +563,7 @@ int kill(int pid)
         {
             p->killed = 1;
             if (p->state == SLEEPING)
-                p->state = RUNNABLE;
+                make_runnable(p);
             release(&ptable.lock);
             return 0;
         }
@@ -516,4 +607,6 @@ void procdump(void)
         }
         cprintf("\n");
     }
-}
\ No newline at end of file
+    for (i = 0; i < ncpu; i++)
+        cprintf("cpu%d: idle %d ticks\n", i, cpus[i].idle_ticks);
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "types.h"
 #include "param.h"    // For NPROC, NCPU, NOFILE
 #include "spinlock.h" // For struct spinlock in ptable
+#include "runqueue.h" // For the per-CPU runqueue
 
 // Forward declarations
 struct taskstate; // From mmu.h
@@ -25,6 +26,9 @@ struct cpu
     int ncli;                  // Depth of pushcli nesting.
     int intena;                // Were interrupts enabled before pushcli?
     struct proc *proc;         // The process running on this cpu or null
+    struct runqueue rq;        // RUNNABLE processes waiting for this cpu
+    volatile uint idle;        // Halted in the idle loop
+    uint idle_ticks;           // Timer ticks spent idle
 };
 extern struct cpu cpus[NCPU];
 extern int ncpu;
@@ -70,6 +74,9 @@ struct proc
     int run_ticks;              // Total CPU time
     int wait_ticks;             // Total waiting time in RUNNABLE state
     int end_ticks;              // Completion time
+    struct proc *next;          // Next process in the runqueue
+    int cpu;                    // CPU whose runqueue holds or last held the process
+    uint runnable_since;        // Tick the process last became RUNNABLE
 };
 
 // Process table structure
@@ -105,4 +112,4 @@ void wakeup(void *);
 int kill(int);
 void procdump(void);
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+// Per-CPU round-robin runqueues.
+// Each CPU keeps a FIFO of its RUNNABLE processes so that picking the
+// next process is O(1) and does not scan the process table.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "runqueue.h"
+
+void rq_init(struct runqueue *rq)
+{
+    initlock(&rq->lock, "runqueue");
+    rq->head = 0;
+    rq->tail = 0;
+    rq->count = 0;
+}
+
+// Append p to the tail of rq.
+void rq_add(struct runqueue *rq, struct proc *p)
+{
+    acquire(&rq->lock);
+    p->next = 0;
+    if (rq->tail)
+        rq->tail->next = p;
+    else
+        rq->head = p;
+    rq->tail = p;
+    if (++rq->count == 1)
+        kick_idle(rq); // Its CPU may be halted
+    release(&rq->lock);
+}
+
+// Remove and return the process at the head of rq, or 0 if it is empty.
+struct proc *
+rq_select(struct runqueue *rq)
+{
+    struct proc *p;
+
+    acquire(&rq->lock);
+    p = rq->head;
+    if (p)
+    {
+        rq->head = p->next;
+        if (rq->head == 0)
+            rq->tail = 0;
+        p->next = 0;
+        rq->count--;
+    }
+    release(&rq->lock);
+    return p;
+}
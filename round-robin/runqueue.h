@@ -0,0 +1,21 @@
+#ifndef _RUNQUEUE_H_
+#define _RUNQUEUE_H_
+
+#include "spinlock.h"
+
+struct proc;
+
+// Per-CPU FIFO of RUNNABLE processes, linked through proc->next
+struct runqueue
+{
+    struct proc *head;    // Next process to run
+    struct proc *tail;    // Most recently queued process
+    int count;            // Number of queued processes
+    struct spinlock lock; // Protects the queue
+};
+
+void rq_init(struct runqueue *rq);
+void rq_add(struct runqueue *rq, struct proc *p);
+struct proc *rq_select(struct runqueue *rq);
+
+#endif // _RUNQUEUE_H_
@@ -55,6 +55,13 @@ void trap(struct trapframe *tf)
             myproc()->run_ticks++;
             // cprintf("trap: pid=%d, run_ticks=%d\n", myproc()->pid, myproc()->run_ticks);
         }
+        if (mycpu()->idle)
+            mycpu()->idle_ticks++;
+        lapiceoi();
+        break;
+
+    case T_IRQ0 + IRQ_WAKEUP:
+        // Work was queued for this idle CPU; the scheduler loop finds it
         lapiceoi();
         break;
 
@@ -106,4 +113,4 @@ void trap(struct trapframe *tf)
 
     if (myproc() && myproc()->killed && (tf->cs & 3) == DPL_USER)
         exit();
-}
\ No newline at end of file
+}
\ No newline at end of file